@@ -0,0 +1,130 @@
+#ifndef S21_ASYNC_H
+#define S21_ASYNC_H
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "s21_parallel.h"
+
+namespace s21 {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+// Shared state of a Task: the result plus the continuations waiting on it.
+template <typename T>
+struct TaskState {
+  std::promise<T> promise;
+  std::shared_future<T> future = promise.get_future().share();
+  std::mutex mutex;
+  bool done = false;
+  std::vector<std::function<void()>> continuations;
+
+  // Publishes the result and schedules everything chained on this task.
+  template <typename F>
+  void Run(F&& f, const std::stop_token& stop) {
+    {
+      StopTokenScope scope(stop);
+      try {
+        ThrowIfCancelled();
+        promise.set_value(f());
+      } catch (...) {
+        promise.set_exception(std::current_exception());
+      }
+    }
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done = true;
+      ready.swap(continuations);
+    }
+    for (auto& continuation : ready) {
+      ThreadPool::Instance().Submit(std::move(continuation));
+    }
+  }
+
+  void OnReady(std::function<void()> continuation) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!done) {
+        continuations.push_back(std::move(continuation));
+        return;
+      }
+    }
+    ThreadPool::Instance().Submit(std::move(continuation));
+  }
+};
+
+}  // namespace detail
+
+// Runs f() on the library's thread pool and returns a Task for its result.
+// Kernels poll the stop token at their cancellation points; a cancelled
+// task finishes with OperationCancelled.
+template <typename F>
+auto Async(F f, std::stop_token stop = {}) -> Task<std::invoke_result_t<F&>>;
+
+// Handle to the result of an asynchronous operation. Copies share the same
+// result. Then() chains a dependent step that is scheduled only once this
+// task has finished, so pipelines never park a pool thread on a wait.
+template <typename T>
+class Task {
+  static_assert(!std::is_void_v<T>, "Task needs a result type");
+
+ public:
+  T Get() const { return state_->future.get(); }
+  void Wait() const { state_->future.wait(); }
+  bool Ready() const {
+    return state_->future.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+  std::shared_future<T> Future() const { return state_->future; }
+
+  // Schedules f(result) after this task. An exception from this task (or a
+  // cancellation) is passed on to the returned task without calling f.
+  template <typename F>
+  auto Then(F f, std::stop_token stop = {}) const
+      -> Task<std::invoke_result_t<F&, const T&>> {
+    using R = std::invoke_result_t<F&, const T&>;
+    auto next = std::make_shared<detail::TaskState<R>>();
+    auto source = state_;
+    state_->OnReady([source, next, f = std::move(f), stop]() mutable {
+      next->Run([&] { return f(source->future.get()); }, stop);
+    });
+    return Task<R>(std::move(next));
+  }
+
+ private:
+  explicit Task(std::shared_ptr<detail::TaskState<T>> state)
+      : state_(std::move(state)) {}
+
+  template <typename U>
+  friend class Task;
+  template <typename F>
+  friend auto Async(F f, std::stop_token stop)
+      -> Task<std::invoke_result_t<F&>>;
+
+  std::shared_ptr<detail::TaskState<T>> state_;
+};
+
+template <typename F>
+auto Async(F f, std::stop_token stop) -> Task<std::invoke_result_t<F&>> {
+  using R = std::invoke_result_t<F&>;
+  auto state = std::make_shared<detail::TaskState<R>>();
+  ThreadPool::Instance().Submit([state, f = std::move(f), stop]() mutable {
+    state->Run(f, stop);
+  });
+  return Task<R>(std::move(state));
+}
+
+}  // namespace s21
+
+#endif
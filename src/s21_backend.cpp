@@ -0,0 +1,485 @@
+#include "s21_backend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_parallel.h"
+#include "s21_tuning.h"
+
+#ifdef S21_HAVE_CBLAS
+#include <cblas.h>
+#endif
+#ifdef S21_HAVE_LAPACKE
+#include <lapacke.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+// Parallel cutoffs and block sizes, see s21::Tunables.
+size_t parallelThreshold() { return Tuning().parallel_threshold; }
+size_t parallelGrain() { return Tuning().parallel_grain; }
+size_t gemmParallelFlops() { return Tuning().gemm_parallel_flops; }
+size_t gemmGrainFlops() { return Tuning().gemm_grain_flops; }
+size_t syrkParallelFlops() { return Tuning().syrk_parallel_flops; }
+size_t luParallelFlops() { return Tuning().lu_parallel_flops; }
+// Right-hand sides solved together by the builtin LuSolve. Each block is a
+// cancellation point, so an inverse stops after at most this many columns.
+constexpr int kSolveColumns = 64;
+
+struct GemmArgs {
+  const double *a;
+  const double *b;
+  double *c;
+  size_t lda, ldb, ldc;
+  int k, n;
+  int k_block;  // rows of b per pass of the untransposed kernel
+  double alpha;
+  bool trans_a, trans_b;
+};
+
+// Accumulates rows [first, last) of alpha * op(a) * op(b) into c. Row ranges
+// are disjoint, so ranges can run on different threads.
+void gemmRows(const GemmArgs &g, size_t first, size_t last) {
+  const double *pa = g.a, *pb = g.b;
+  const size_t lda = g.lda, ldb = g.ldb, ldc = g.ldc;
+  const int k = g.k, n = g.n;
+  const double alpha = g.alpha;
+
+  if (!g.trans_a && !g.trans_b) {
+    // Every row of the range sweeps the same k_block rows of b before the
+    // next ones; each c(i, j) still sums over p in order.
+    for (int p0 = 0; p0 < k; p0 += g.k_block) {
+      const int p1 = std::min(k, p0 + g.k_block);
+      ThrowIfCancelled();
+      for (size_t i = first; i < last; i++) {
+        double *c_row = g.c + i * ldc;
+        for (int p = p0; p < p1; p++) {
+          const double a_ip = alpha * pa[i * lda + p];
+          const double *b_row = pb + p * ldb;
+          for (int j = 0; j < n; j++) c_row[j] += a_ip * b_row[j];
+        }
+      }
+    }
+  } else if (!g.trans_a && g.trans_b) {
+    for (size_t i = first; i < last; i++) {
+      ThrowIfCancelled();
+      const double *a_row = pa + i * lda;
+      for (int j = 0; j < n; j++) {
+        const double *b_row = pb + j * ldb;
+        double sum = 0.0;
+        for (int p = 0; p < k; p++) sum += a_row[p] * b_row[p];
+        g.c[i * ldc + j] += alpha * sum;
+      }
+    }
+  } else if (g.trans_a && !g.trans_b) {
+    for (int p = 0; p < k; p++) {
+      ThrowIfCancelled();
+      const double *a_row = pa + p * lda;
+      const double *b_row = pb + p * ldb;
+      for (size_t i = first; i < last; i++) {
+        const double a_pi = alpha * a_row[i];
+        double *c_row = g.c + i * ldc;
+        for (int j = 0; j < n; j++) c_row[j] += a_pi * b_row[j];
+      }
+    }
+  } else {
+    for (size_t i = first; i < last; i++) {
+      ThrowIfCancelled();
+      double *c_row = g.c + i * ldc;
+      for (int p = 0; p < k; p++) {
+        const double a_pi = alpha * pa[p * lda + i];
+        for (int j = 0; j < n; j++) c_row[j] += a_pi * pb[j * ldb + p];
+      }
+    }
+  }
+}
+
+// One pass of Syrk over a panel of `count` rows of n elements: c(i, j) +=
+// alpha * sum_p panel(p, i) * panel(p, j). For A^T A the panel is a block of
+// rows of A; for A A^T it is a block of columns of A packed as rows, so both
+// run as rank-one updates whose inner loop vectorizes.
+struct SyrkPanel {
+  const double *panel;
+  double *c;
+  size_t ldp, ldc;
+  int count;
+  double alpha;
+};
+
+// Accumulates rows [first, last) of the lower triangle of a panel pass,
+// four rows of c at a time so that each panel element loaded feeds four
+// multiply-adds.
+void syrkRows(const SyrkPanel &s, size_t first, size_t last) {
+  ThrowIfCancelled();
+  size_t i = first;
+  for (; i + 4 <= last; i += 4) {
+    double *c0 = s.c + i * s.ldc, *c1 = c0 + s.ldc, *c2 = c1 + s.ldc,
+           *c3 = c2 + s.ldc;
+    for (int p = 0; p < s.count; p++) {
+      const double *row = s.panel + p * s.ldp;
+      const double a0 = s.alpha * row[i], a1 = s.alpha * row[i + 1],
+                   a2 = s.alpha * row[i + 2], a3 = s.alpha * row[i + 3];
+      for (size_t j = 0; j <= i; j++) {
+        const double r = row[j];
+        c0[j] += a0 * r;
+        c1[j] += a1 * r;
+        c2[j] += a2 * r;
+        c3[j] += a3 * r;
+      }
+      // The corner below the diagonal of the four rows.
+      c1[i + 1] += a1 * row[i + 1];
+      c2[i + 1] += a2 * row[i + 1];
+      c2[i + 2] += a2 * row[i + 2];
+      c3[i + 1] += a3 * row[i + 1];
+      c3[i + 2] += a3 * row[i + 2];
+      c3[i + 3] += a3 * row[i + 3];
+    }
+  }
+  for (; i < last; i++) {
+    double *c_row = s.c + i * s.ldc;
+    for (int p = 0; p < s.count; p++) {
+      const double *row = s.panel + p * s.ldp;
+      const double a_pi = s.alpha * row[i];
+      for (size_t j = 0; j <= i; j++) c_row[j] += a_pi * row[j];
+    }
+  }
+}
+
+// y = beta * y, treating beta == 0 as an overwrite so stale NaNs never leak.
+void scaleOutput(double *y, size_t size, double beta) {
+  if (beta == 0.0) {
+    std::fill(y, y + size, 0.0);
+  } else if (beta != 1.0) {
+    for (size_t i = 0; i < size; i++) y[i] *= beta;
+  }
+}
+
+class BuiltinKernels : public Backend {
+ public:
+  const char *Name() const noexcept override { return "builtin"; }
+
+  void Gemm(bool trans_a, bool trans_b, int m, int n, int k, double alpha,
+            const double *a, int lda, const double *b, int ldb, double beta,
+            double *c, int ldc) const override {
+    for (int i = 0; i < m; i++) {
+      scaleOutput(c + static_cast<size_t>(i) * ldc, n, beta);
+    }
+    if (alpha == 0.0 || k == 0) return;
+
+    const int k_block = static_cast<int>(
+        std::min<size_t>(Tuning().gemm_k_block, static_cast<size_t>(k)));
+    GemmArgs args{a, b, c, static_cast<size_t>(lda), static_cast<size_t>(ldb),
+                  static_cast<size_t>(ldc), k, n, k_block, alpha, trans_a,
+                  trans_b};
+    const size_t flops = static_cast<size_t>(m) * n * k;
+    if (flops < gemmParallelFlops()) {
+      gemmRows(args, 0, m);
+    } else {
+      const size_t grain = std::max<size_t>(
+          1, gemmGrainFlops() / (static_cast<size_t>(n) * k));
+      ParallelFor(0, m, grain, [&args](size_t first, size_t last) {
+        gemmRows(args, first, last);
+      });
+    }
+  }
+
+  // Row i of the triangle costs i + 1 multiply-adds per panel row, so the
+  // parallel bands get equal areas rather than equal row counts.
+  void Syrk(bool trans, int n, int k, double alpha, const double *a, int lda,
+            double beta, double *c, int ldc) const override {
+    for (int i = 0; i < n; i++) {
+      scaleOutput(c + static_cast<size_t>(i) * ldc, i + 1, beta);
+    }
+    if (alpha == 0.0 || k == 0) return;
+
+    const int k_block = static_cast<int>(
+        std::min<size_t>(Tuning().gemm_k_block, static_cast<size_t>(k)));
+    const size_t flops = static_cast<size_t>(n) * (n + 1) / 2 * k;
+    const size_t bands =
+        std::min<size_t>(n, std::max<size_t>(1, flops / gemmGrainFlops()));
+    const bool parallel = flops >= syrkParallelFlops() && bands > 1;
+    auto bound = [n, bands](size_t band) {
+      return static_cast<size_t>(
+          std::lround(n * std::sqrt(static_cast<double>(band) / bands)));
+    };
+    std::vector<double> packed;
+    if (!trans) packed.resize(static_cast<size_t>(k_block) * n);
+
+    // Each c(i, j) sums over p in order, whatever the banding.
+    for (int p0 = 0; p0 < k; p0 += k_block) {
+      const int count = std::min(k, p0 + k_block) - p0;
+      SyrkPanel pass{nullptr, c, static_cast<size_t>(lda),
+                     static_cast<size_t>(ldc), count, alpha};
+      if (trans) {
+        pass.panel = a + static_cast<size_t>(p0) * lda;
+      } else {
+        for (int j = 0; j < n; j++) {
+          const double *a_row = a + static_cast<size_t>(j) * lda + p0;
+          for (int p = 0; p < count; p++) {
+            packed[static_cast<size_t>(p) * n + j] = a_row[p];
+          }
+        }
+        pass.panel = packed.data();
+        pass.ldp = n;
+      }
+      if (!parallel) {
+        syrkRows(pass, 0, n);
+      } else {
+        ParallelFor(0, bands, 1, [&](size_t first, size_t last) {
+          syrkRows(pass, bound(first), bound(last));
+        });
+      }
+    }
+  }
+
+  void Gemv(bool trans, int m, int n, double alpha, const double *a, int lda,
+            const double *x, double beta, double *y) const override {
+    const size_t ld = lda;
+    const size_t work = static_cast<size_t>(m) * n;
+    if (!trans) {
+      auto rows = [=](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          const double *row = a + i * ld;
+          double sum = 0.0;
+          for (int j = 0; j < n; j++) sum += row[j] * x[j];
+          y[i] = alpha * sum + (beta == 0.0 ? 0.0 : beta * y[i]);
+        }
+      };
+      if (work < parallelThreshold()) {
+        rows(0, m);
+      } else {
+        ParallelFor(0, m, std::max<size_t>(1, parallelGrain() / n), rows);
+      }
+    } else {
+      // y_j accumulates down column j, so threads split the columns.
+      auto cols = [=](size_t first, size_t last) {
+        scaleOutput(y + first, last - first, beta);
+        for (int i = 0; i < m; i++) {
+          const double *row = a + i * ld;
+          const double xi = alpha * x[i];
+          for (size_t j = first; j < last; j++) y[j] += xi * row[j];
+        }
+      };
+      if (work < parallelThreshold()) {
+        cols(0, n);
+      } else {
+        ParallelFor(0, n, std::max<size_t>(1, parallelGrain() / m), cols);
+      }
+    }
+  }
+
+  double LuFactor(int n, double *a, int lda, int *pivots) const override {
+    const size_t ld = lda;
+    double det = 1.0;
+    for (int k = 0; k < n; k++) {
+      ThrowIfCancelled();
+      int max_row = k;
+      for (int i = k + 1; i < n; i++) {
+        if (std::fabs(a[i * ld + k]) > std::fabs(a[max_row * ld + k])) {
+          max_row = i;
+        }
+      }
+      pivots[k] = max_row;
+      if (max_row != k) {
+        std::swap_ranges(a + k * ld, a + k * ld + n, a + max_row * ld);
+        det = -det;
+      }
+      const double pivot = a[k * ld + k];
+      det *= pivot;
+      if (pivot == 0.0) {
+        for (int i = k + 1; i < n; i++) pivots[i] = i;
+        return 0.0;
+      }
+
+      const double *pivot_row = a + k * ld;
+      auto update = [=](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          double *row = a + i * ld;
+          const double ratio = row[k] / pivot;
+          row[k] = ratio;
+          for (int j = k + 1; j < n; j++) row[j] -= ratio * pivot_row[j];
+        }
+      };
+      const size_t rest = n - k - 1;
+      if (rest * rest < luParallelFlops()) {
+        update(k + 1, n);
+      } else {
+        ParallelFor(k + 1, n, std::max<size_t>(1, parallelGrain() / rest),
+                    update);
+      }
+    }
+    return det;
+  }
+
+  void LuSolve(int n, int nrhs, const double *lu, int ldlu, const int *pivots,
+               double *b, int ldb) const override {
+    const size_t ld = ldlu, ldx = ldb;
+    for (int k = 0; k < n; k++) {
+      if (pivots[k] != k) {
+        std::swap_ranges(b + k * ldx, b + k * ldx + nrhs, b + pivots[k] * ldx);
+      }
+    }
+    for (int j0 = 0; j0 < nrhs; j0 += kSolveColumns) {
+      ThrowIfCancelled();
+      const int j1 = std::min(nrhs, j0 + kSolveColumns);
+      for (int i = 1; i < n; i++) {
+        double *row = b + i * ldx;
+        for (int p = 0; p < i; p++) {
+          const double l = lu[i * ld + p];
+          const double *src = b + p * ldx;
+          for (int j = j0; j < j1; j++) row[j] -= l * src[j];
+        }
+      }
+      for (int i = n - 1; i >= 0; i--) {
+        double *row = b + i * ldx;
+        for (int p = i + 1; p < n; p++) {
+          const double u = lu[i * ld + p];
+          const double *src = b + p * ldx;
+          for (int j = j0; j < j1; j++) row[j] -= u * src[j];
+        }
+        const double diag = lu[i * ld + i];
+        for (int j = j0; j < j1; j++) row[j] /= diag;
+      }
+    }
+  }
+
+  // Tile by tile, so that both the reads and the strided writes stay in
+  // cache; bands of tile rows run in parallel for large matrices.
+  void Transpose(int rows, int cols, const double *a,
+                 double *b) const override {
+    const size_t lda = cols, ldb = rows;
+    const int tile = static_cast<int>(
+        std::min<size_t>(Tuning().transpose_tile, std::max(rows, cols)));
+    auto bands = [=](size_t first, size_t last) {
+      for (size_t band = first; band < last; band++) {
+        const int i0 = static_cast<int>(band) * tile;
+        const int i1 = std::min(rows, i0 + tile);
+        for (int j0 = 0; j0 < cols; j0 += tile) {
+          const int j1 = std::min(cols, j0 + tile);
+          for (int i = i0; i < i1; i++) {
+            for (int j = j0; j < j1; j++) b[j * ldb + i] = a[i * lda + j];
+          }
+        }
+      }
+    };
+    const size_t band_count = (rows + tile - 1) / tile;
+    if (static_cast<size_t>(rows) * cols < parallelThreshold()) {
+      bands(0, band_count);
+    } else {
+      ParallelFor(0, band_count,
+                  std::max<size_t>(1, parallelGrain() / tile / cols),
+                  bands);
+    }
+  }
+};
+
+#ifdef S21_HAVE_CBLAS
+
+// CBLAS has no out-of-place transpose, so that one stays built in, and so
+// do LU and solve when LAPACKE is missing.
+class BlasKernels final : public BuiltinKernels {
+ public:
+  const char *Name() const noexcept override { return "blas"; }
+
+  void Gemm(bool trans_a, bool trans_b, int m, int n, int k, double alpha,
+            const double *a, int lda, const double *b, int ldb, double beta,
+            double *c, int ldc) const override {
+    ThrowIfCancelled();
+    cblas_dgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans, m, n, k, alpha, a, lda, b,
+                ldb, beta, c, ldc);
+  }
+
+  void Syrk(bool trans, int n, int k, double alpha, const double *a, int lda,
+            double beta, double *c, int ldc) const override {
+    ThrowIfCancelled();
+    cblas_dsyrk(CblasRowMajor, CblasLower, trans ? CblasTrans : CblasNoTrans,
+                n, k, alpha, a, lda, beta, c, ldc);
+  }
+
+  void Gemv(bool trans, int m, int n, double alpha, const double *a, int lda,
+            const double *x, double beta, double *y) const override {
+    cblas_dgemv(CblasRowMajor, trans ? CblasTrans : CblasNoTrans, m, n, alpha,
+                a, lda, x, 1, beta, y, 1);
+  }
+
+#ifdef S21_HAVE_LAPACKE
+  double LuFactor(int n, double *a, int lda, int *pivots) const override {
+    ThrowIfCancelled();
+    std::vector<lapack_int> ipiv(n);
+    const lapack_int info =
+        LAPACKE_dgetrf(LAPACK_ROW_MAJOR, n, n, a, lda, ipiv.data());
+    if (info < 0) {
+      throw std::invalid_argument("ERROR: LAPACKE_dgetrf rejected its input");
+    }
+    double det = 1.0;
+    for (int k = 0; k < n; k++) {
+      pivots[k] = static_cast<int>(ipiv[k]) - 1;
+      if (pivots[k] != k) det = -det;
+      det *= a[static_cast<size_t>(k) * lda + k];
+    }
+    return info > 0 ? 0.0 : det;
+  }
+
+  void LuSolve(int n, int nrhs, const double *lu, int ldlu, const int *pivots,
+               double *b, int ldb) const override {
+    ThrowIfCancelled();
+    std::vector<lapack_int> ipiv(pivots, pivots + n);
+    for (lapack_int &p : ipiv) p++;
+    const lapack_int info = LAPACKE_dgetrs(LAPACK_ROW_MAJOR, 'N', n, nrhs, lu,
+                                           ldlu, ipiv.data(), b, ldb);
+    if (info < 0) {
+      throw std::invalid_argument("ERROR: LAPACKE_dgetrs rejected its input");
+    }
+  }
+#endif
+};
+
+#endif
+
+const Backend *initialBackend() {
+  const char *env = std::getenv("S21_BACKEND");
+  if (env != nullptr && std::strcmp(env, "blas") == 0 &&
+      BlasBackend() != nullptr) {
+    return BlasBackend();
+  }
+  return &BuiltinBackend();
+}
+
+std::atomic<const Backend *> &currentBackend() {
+  static std::atomic<const Backend *> current{initialBackend()};
+  return current;
+}
+
+}  // namespace
+
+const Backend &BuiltinBackend() noexcept {
+  static const BuiltinKernels builtin;
+  return builtin;
+}
+
+const Backend *BlasBackend() noexcept {
+#ifdef S21_HAVE_CBLAS
+  static const BlasKernels blas;
+  return &blas;
+#else
+  return nullptr;
+#endif
+}
+
+void SetBackend(const Backend &backend) noexcept {
+  currentBackend().store(&backend, std::memory_order_release);
+}
+
+const Backend &CurrentBackend() noexcept {
+  return *currentBackend().load(std::memory_order_acquire);
+}
+
+}  // namespace s21
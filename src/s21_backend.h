@@ -0,0 +1,61 @@
+#ifndef S21_BACKEND_H
+#define S21_BACKEND_H
+
+namespace s21 {
+
+// Dense kernels behind S21Matrix. Every matrix is row-major and addressed
+// through a leading dimension (the distance between consecutive rows).
+// Gemm, Syrk and InverseMatrix of S21Matrix, Determinant, Solve and
+// Transpose, and the S21Matrix overloads of the Krylov solvers go through
+// the current backend.
+class Backend {
+ public:
+  virtual ~Backend() = default;
+
+  virtual const char* Name() const noexcept = 0;
+
+  // C = alpha * op(A) * op(B) + beta * C with C m x n and op(A) m x k; C is
+  // not read when beta == 0.
+  virtual void Gemm(bool trans_a, bool trans_b, int m, int n, int k,
+                    double alpha, const double* a, int lda, const double* b,
+                    int ldb, double beta, double* c, int ldc) const = 0;
+  // Lower triangle of C = alpha * op(A) * op(A)^T + beta * C for the n x n
+  // C, with op(A) = A (n x k) or, when trans, A^T (A is k x n). The strict
+  // upper triangle of C is neither read nor written.
+  virtual void Syrk(bool trans, int n, int k, double alpha, const double* a,
+                    int lda, double beta, double* c, int ldc) const = 0;
+  // y = alpha * op(A) * x + beta * y for the m x n matrix A; y is not read
+  // when beta == 0.
+  virtual void Gemv(bool trans, int m, int n, double alpha, const double* a,
+                    int lda, const double* x, double beta,
+                    double* y) const = 0;
+  // In-place LU factorization with partial pivoting of the n x n matrix A:
+  // the strict lower triangle receives L (unit diagonal) and the upper
+  // triangle U. pivots[k] is the row swapped with row k at step k. Returns
+  // det(A), which is 0 exactly when a pivot is 0.
+  virtual double LuFactor(int n, double* a, int lda, int* pivots) const = 0;
+  // Solves A X = B in place for the n x nrhs matrix B, given the output of
+  // LuFactor for a nonsingular A.
+  virtual void LuSolve(int n, int nrhs, const double* lu, int ldlu,
+                       const int* pivots, double* b, int ldb) const = 0;
+  // B = A^T for the rows x cols matrix A; B has leading dimension rows.
+  virtual void Transpose(int rows, int cols, const double* a,
+                         double* b) const = 0;
+};
+
+// The dependency-free kernels of the library, the default backend.
+const Backend& BuiltinBackend() noexcept;
+// CBLAS for the products and, with S21_HAVE_LAPACKE, LAPACKE for LU and
+// solve; nullptr when the library was built without S21_HAVE_CBLAS. The
+// Makefile defines both macros for the libraries it finds.
+const Backend* BlasBackend() noexcept;
+
+// Selects the backend used from now on; it must outlive its use. The
+// initial one is the built-in backend, or the BLAS one when the S21_BACKEND
+// environment variable is "blas" and it is available.
+void SetBackend(const Backend& backend) noexcept;
+const Backend& CurrentBackend() noexcept;
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,80 @@
+// Row-major vs tiled layout timings. Run with `make bench`; the row where
+// the speedup column first exceeds 1 is the size from which tiling pays off
+// on this host. The last rows compare the checked At() with a raw pointer
+// for an element-by-element update loop.
+
+#include <chrono>
+#include <cstdio>
+
+#include "s21_matrix.h"
+#include "s21_tiled.h"
+
+namespace {
+
+template <typename F>
+double bestOf(int repeats, const F &f) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < best) best = elapsed.count();
+  }
+  return best;
+}
+
+S21Matrix filled(int n) {
+  S21Matrix m(n, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) m.At(i, j) = (i * 31 + j * 17) % 13 - 6.0;
+  }
+  return m;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%-10s %6s %12s %12s %8s\n", "operation", "n", "row-major",
+              "tiled", "speedup");
+  for (int n : {64, 128, 256, 512, 1024}) {
+    const S21Matrix a = filled(n);
+    const S21TiledMatrix ta(a);
+    S21Matrix c;
+    S21TiledMatrix tc;
+    const int repeats = n <= 256 ? 5 : 2;
+    const double dense =
+        bestOf(repeats, [&] { S21Matrix::Gemm(1.0, a, a, 0.0, c); });
+    const double tiled =
+        bestOf(repeats, [&] { S21TiledMatrix::Mul(ta, ta, tc); });
+    std::printf("%-10s %6d %12.6f %12.6f %8.2f\n", "multiply", n, dense, tiled,
+                dense / tiled);
+  }
+  for (int n : {256, 1024, 2048, 4096}) {
+    const S21Matrix a = filled(n);
+    const S21TiledMatrix ta(a);
+    const double dense = bestOf(3, [&] { a.Transpose(); });
+    const double tiled = bestOf(3, [&] { ta.Transpose(); });
+    std::printf("%-10s %6d %12.6f %12.6f %8.2f\n", "transpose", n, dense,
+                tiled, dense / tiled);
+  }
+  std::printf("%-10s %6s %12s %12s %8s\n", "accessor", "n", "At()",
+              "pointer", "ratio");
+  for (int n : {256, 1024, 2048}) {
+    S21Matrix a = filled(n);
+    const double at = bestOf(5, [&] {
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) a.At(i, j) += 1.0;
+      }
+    });
+    const double pointer = bestOf(5, [&] {
+      double *data = a.data();
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) data[static_cast<size_t>(i) * n + j] += 1.0;
+      }
+    });
+    std::printf("%-10s %6d %12.6f %12.6f %8.2f\n", "update", n, at, pointer,
+                at / pointer);
+  }
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include "s21_cache.h"
+
+#include <cstring>
+
+namespace s21 {
+
+namespace {
+
+bool sameContents(const S21Matrix &a, const S21Matrix &b) {
+  return a.GetRows() == b.GetRows() && a.GetCols() == b.GetCols() &&
+         (a.size() == 0 ||
+          std::memcmp(a.data(), b.data(), sizeof(double) * a.size()) == 0);
+}
+
+// A private copy of the elements, never shared with `operand` even in
+// copy-on-write mode: a shared one would follow later writes through stale
+// pointers into `operand`, and the check of find() would compare the
+// elements with themselves.
+std::shared_ptr<const S21Matrix> snapshot(const S21Matrix &operand) {
+  if (operand.size() == 0) return std::make_shared<const S21Matrix>();
+  auto copy = std::make_shared<S21Matrix>(
+      operand.GetRows(), operand.GetCols(), S21Matrix::uninitialized);
+  std::memcpy(copy->data(), operand.data(), sizeof(double) * operand.size());
+  return copy;
+}
+
+}  // namespace
+
+ResultCache &ResultCache::Instance() {
+  static ResultCache cache;
+  return cache;
+}
+
+size_t ResultCache::KeyHash::operator()(const Key &key) const noexcept {
+  return key.hash ^ (static_cast<size_t>(key.op) << 56) ^
+         (static_cast<size_t>(key.parameter) * 0x9E3779B97F4A7C15ULL);
+}
+
+void ResultCache::SetCapacity(size_t entries) {
+  std::lock_guard lock(mutex_);
+  capacity_.store(entries, std::memory_order_relaxed);
+  trim(entries);
+}
+
+size_t ResultCache::Capacity() const noexcept {
+  return capacity_.load(std::memory_order_relaxed);
+}
+
+CacheStats ResultCache::Stats() const {
+  CacheStats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  std::lock_guard lock(mutex_);
+  stats.entries = entries_.size();
+  return stats;
+}
+
+void ResultCache::Clear() {
+  std::lock_guard lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+// The operand comparison runs outside the lock; the shared pointers keep the
+// entry alive even if another thread evicts it meanwhile.
+std::shared_ptr<const void> ResultCache::find(const Key &key,
+                                              const S21Matrix &operand) {
+  std::shared_ptr<const S21Matrix> stored;
+  std::shared_ptr<const void> result;
+  {
+    std::lock_guard lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      stored = it->second->operand;
+      result = it->second->result;
+    }
+  }
+  if (stored != nullptr && sameContents(*stored, operand)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return result;
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+// A colliding entry, or one that a concurrent miss stored first, is
+// replaced by the newer result.
+void ResultCache::insert(const Key &key, const S21Matrix &operand,
+                         std::shared_ptr<const void> result) {
+  std::shared_ptr<const S21Matrix> copy = snapshot(operand);
+  std::lock_guard lock(mutex_);
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+  if (capacity == 0) return;
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    it->second->operand = std::move(copy);
+    it->second->result = std::move(result);
+    return;
+  }
+  entries_.push_front(Entry{key, std::move(copy), std::move(result)});
+  index_.emplace(key, entries_.begin());
+  trim(capacity);
+}
+
+// Drops least recently used entries down to `capacity`; the caller holds
+// the mutex.
+void ResultCache::trim(size_t capacity) {
+  while (entries_.size() > capacity) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,99 @@
+#ifndef S21_CACHE_H
+#define S21_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "s21_matrix.h"
+
+namespace s21 {
+
+// Operations whose results the cache may hold.
+enum class CachedOperation {
+  kDeterminant,
+  kInverse,
+  kComplements,
+  kQr,
+  kSvd,
+  kSymmetricEigen,
+};
+
+struct CacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+  size_t entries = 0;
+};
+
+// Process-wide memo of expensive results, keyed by the content hash of the
+// operand, the operation and an integer parameter of it. Off by default;
+// once given a capacity it keeps that many of the most recently used
+// results. Every entry keeps a copy of its operand, compared element by
+// element on a hit, so a hash collision costs a miss rather than a wrong
+// answer. All members may be called from several threads at once.
+class ResultCache {
+ public:
+  static ResultCache& Instance();
+
+  ResultCache(const ResultCache&) = delete;
+  ResultCache& operator=(const ResultCache&) = delete;
+
+  // Maximum number of entries; 0 disables the cache and empties it.
+  void SetCapacity(size_t entries);
+  size_t Capacity() const noexcept;
+  CacheStats Stats() const;
+  // Drops every entry and resets the statistics.
+  void Clear();
+
+  // The cached result of `op` on `operand`, or compute() stored for next
+  // time. Exceptions thrown by compute() propagate and nothing is stored.
+  template <typename T, typename Compute>
+  T GetOrCompute(CachedOperation op, const S21Matrix& operand,
+                 Compute compute, int parameter = 0) {
+    if (Capacity() == 0) return compute();
+    const Key key{operand.Hash(), op, parameter};
+    if (std::shared_ptr<const void> hit = find(key, operand)) {
+      return *std::static_pointer_cast<const T>(hit);
+    }
+    auto result = std::make_shared<const T>(compute());
+    insert(key, operand, result);
+    return *result;
+  }
+
+ private:
+  struct Key {
+    uint64_t hash;
+    CachedOperation op;
+    int parameter;
+    bool operator==(const Key&) const = default;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const noexcept;
+  };
+  struct Entry {
+    Key key;
+    std::shared_ptr<const S21Matrix> operand;
+    std::shared_ptr<const void> result;
+  };
+
+  ResultCache() = default;
+  std::shared_ptr<const void> find(const Key& key, const S21Matrix& operand);
+  void insert(const Key& key, const S21Matrix& operand,
+              std::shared_ptr<const void> result);
+  void trim(size_t capacity);
+
+  mutable std::mutex mutex_;
+  std::atomic<size_t> capacity_{0};
+  std::atomic<size_t> hits_{0}, misses_{0}, evictions_{0};
+  std::list<Entry> entries_;  // most recently used first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+};
+
+}  // namespace s21
+
+#endif
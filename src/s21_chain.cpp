@@ -0,0 +1,176 @@
+#include "s21_chain.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "s21_backend.h"
+
+S21MatrixChain::S21MatrixChain(const S21Matrix &first) { *this *= first; }
+
+S21MatrixChain &S21MatrixChain::operator*=(const S21Matrix &next) {
+  if (next.GetRows() <= 0 || next.GetCols() <= 0) {
+    throw std::invalid_argument("ERROR: empty operand");
+  }
+  if (!operands_.empty() && operands_.back()->GetCols() != next.GetRows()) {
+    throw std::invalid_argument("ERROR: operand shapes do not match");
+  }
+  operands_.push_back(&next);
+  planned_ = false;
+  return *this;
+}
+
+S21MatrixChain operator*(S21MatrixChain chain, const S21Matrix &next) {
+  chain *= next;
+  return chain;
+}
+
+void S21MatrixChain::plan() const {
+  if (operands_.empty()) {
+    throw std::logic_error("ERROR: empty chain");
+  }
+  const int n = Size();
+  // An operand may have been resized since the last plan.
+  bool same = planned_ && dims_.size() == static_cast<size_t>(n) + 1;
+  for (int t = 0; t < n && same; t++) {
+    same = operands_[t]->GetRows() == dims_[t] &&
+           operands_[t]->GetCols() == dims_[t + 1];
+  }
+  if (same) return;
+  planned_ = false;
+  dims_.resize(n + 1);
+  for (int t = 0; t < n; t++) dims_[t] = operands_[t]->GetRows();
+  dims_[n] = operands_[n - 1]->GetCols();
+  for (int t = 0; t < n; t++) {
+    if (dims_[t] <= 0 || operands_[t]->GetCols() != dims_[t + 1]) {
+      throw std::invalid_argument("ERROR: operand shapes do not match");
+    }
+  }
+  const std::vector<int> &dims = dims_;
+
+  // cost[i][j]: cheapest way to form operands i..j; split[i][j]: the k of
+  // the final (i..k) * (k+1..j) product.
+  std::vector<double> cost(static_cast<size_t>(n) * n, 0.0);
+  std::vector<int> split(static_cast<size_t>(n) * n, 0);
+  for (int len = 2; len <= n; len++) {
+    for (int i = 0; i + len - 1 < n; i++) {
+      const int j = i + len - 1;
+      double best = std::numeric_limits<double>::infinity();
+      for (int k = i; k < j; k++) {
+        const double c = cost[i * n + k] + cost[(k + 1) * n + j] +
+                         dims[i] * dims[k + 1] * dims[j + 1];
+        if (c < best) {
+          best = c;
+          split[i * n + j] = k;
+        }
+      }
+      cost[i * n + j] = best;
+    }
+  }
+  planned_flops_ = cost[n - 1];
+
+  nodes_.clear();
+  if (n > 1) buildNodes(split, 0, n - 1);
+  assignSlots();
+  planned_ = true;
+}
+
+int S21MatrixChain::buildNodes(const std::vector<int> &split, int i,
+                               int j) const {
+  if (i == j) return ~i;
+  const int k = split[static_cast<size_t>(i) * Size() + j];
+  const int left = buildNodes(split, i, k);
+  const int right = buildNodes(split, k + 1, j);
+  nodes_.push_back({left, right, dims_[i], dims_[j + 1], -1});
+  return static_cast<int>(nodes_.size()) - 1;
+}
+
+// Gives every intermediate product a slot that is free while it is alive:
+// from its evaluation until its parent's. A freed slot of the same size is
+// preferred, then the largest free one; slots only grow.
+void S21MatrixChain::assignSlots() const {
+  std::vector<size_t> sizes;
+  std::vector<int> free_slots;
+  const int last = static_cast<int>(nodes_.size()) - 1;
+  for (int t = 0; t < last; t++) {
+    Node &node = nodes_[t];
+    const size_t size = static_cast<size_t>(node.rows) * node.cols;
+    auto pick = std::find_if(free_slots.begin(), free_slots.end(),
+                             [&](int slot) { return sizes[slot] == size; });
+    if (pick == free_slots.end()) {
+      pick = std::max_element(
+          free_slots.begin(), free_slots.end(),
+          [&](int x, int y) { return sizes[x] < sizes[y]; });
+    }
+    if (pick != free_slots.end()) {
+      node.slot = *pick;
+      free_slots.erase(pick);
+      sizes[node.slot] = std::max(sizes[node.slot], size);
+    } else {
+      node.slot = static_cast<int>(sizes.size());
+      sizes.push_back(size);
+    }
+    for (int child : {node.left, node.right}) {
+      if (child >= 0) free_slots.push_back(nodes_[child].slot);
+    }
+  }
+  if (slots_.size() < sizes.size()) slots_.resize(sizes.size());
+  for (size_t slot = 0; slot < sizes.size(); slot++) {
+    if (slots_[slot].size() < sizes[slot]) slots_[slot].resize(sizes[slot]);
+  }
+}
+
+S21MatrixChain::View S21MatrixChain::view(int ref) const {
+  if (ref < 0) {
+    const S21Matrix &operand = *operands_[~ref];
+    return {operand.data(), operand.GetRows(), operand.GetCols()};
+  }
+  const Node &node = nodes_[ref];
+  return {slots_[node.slot].data(), node.rows, node.cols};
+}
+
+double S21MatrixChain::PlannedFlops() const {
+  plan();
+  return planned_flops_;
+}
+
+double S21MatrixChain::NaiveFlops() const {
+  double flops = 0.0;
+  for (int t = 1; t < Size(); t++) {
+    flops += static_cast<double>(operands_[0]->GetRows()) *
+             operands_[t]->GetRows() * operands_[t]->GetCols();
+  }
+  return flops;
+}
+
+std::string S21MatrixChain::describe(int ref) const {
+  if (ref < 0) return "A" + std::to_string(~ref);
+  return "(" + describe(nodes_[ref].left) + " " +
+         describe(nodes_[ref].right) + ")";
+}
+
+std::string S21MatrixChain::Plan() const {
+  plan();
+  return describe(nodes_.empty() ? ~0 : static_cast<int>(nodes_.size()) - 1);
+}
+
+const S21Matrix &S21MatrixChain::Evaluate() {
+  plan();
+  if (nodes_.empty()) return *operands_[0];
+  const Node &root = nodes_.back();
+  if (result_.GetRows() != root.rows || result_.GetCols() != root.cols) {
+    result_ = S21Matrix(root.rows, root.cols, S21Matrix::uninitialized);
+  }
+  // Children always precede their parent in nodes_, so one forward pass
+  // evaluates the tree.
+  const s21::Backend &backend = s21::CurrentBackend();
+  for (size_t t = 0; t < nodes_.size(); t++) {
+    const View left = view(nodes_[t].left), right = view(nodes_[t].right);
+    double *out = t + 1 == nodes_.size() ? result_.data()
+                                         : slots_[nodes_[t].slot].data();
+    backend.Gemm(false, false, left.rows, right.cols, left.cols, 1.0,
+                 left.data, left.cols, right.data, right.cols, 0.0, out,
+                 right.cols);
+  }
+  return result_;
+}
@@ -0,0 +1,71 @@
+#ifndef S21_CHAIN_H
+#define S21_CHAIN_H
+
+#include <string>
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Lazy product A0 * A1 * ... * An-1. Operands are recorded, not multiplied;
+// Evaluate() picks the parenthesization with the fewest multiply-adds
+// (classic O(n^3) dynamic programme) and runs it through the backend Gemm.
+// Intermediate products share a few buffers owned by the chain, each reused
+// once the product stored in it has been consumed (two for a left-to-right
+// order), so evaluating the same chain again with same-shaped operands
+// allocates nothing. The plan is redone when an operand changes shape.
+//
+// The chain keeps pointers to its operands: they must outlive it, and
+// temporaries are rejected.
+class S21MatrixChain {
+ public:
+  S21MatrixChain() = default;
+  explicit S21MatrixChain(const S21Matrix& first);
+  explicit S21MatrixChain(const S21Matrix&& first) = delete;
+
+  // Appends an operand; throws std::invalid_argument on a shape mismatch.
+  S21MatrixChain& operator*=(const S21Matrix& next);
+  S21MatrixChain& operator*=(const S21Matrix&& next) = delete;
+
+  int Size() const noexcept { return static_cast<int>(operands_.size()); }
+  // Multiply-adds of the planned order and of plain left-to-right order.
+  double PlannedFlops() const;
+  double NaiveFlops() const;
+  // The planned order, e.g. "((A0 A1) A2)".
+  std::string Plan() const;
+
+  // Computes the product. The result is owned by the chain and stays valid
+  // until the next Evaluate() or until the chain is modified.
+  const S21Matrix& Evaluate();
+
+ private:
+  struct Node {
+    int left, right;  // child node indices; < 0 encodes operand ~index
+    int rows, cols;
+    int slot;  // index into slots_; the last node writes to result_
+  };
+  struct View {
+    const double* data;
+    int rows, cols;
+  };
+
+  std::vector<const S21Matrix*> operands_;
+  // Plan cache, rebuilt lazily after the operand list or a shape changes.
+  mutable std::vector<int> dims_;  // operand t is dims_[t] x dims_[t + 1]
+  mutable std::vector<Node> nodes_;  // product nodes in evaluation order
+  mutable std::vector<std::vector<double>> slots_;
+  mutable double planned_flops_ = 0.0;
+  mutable bool planned_ = false;
+  S21Matrix result_;
+
+  void plan() const;
+  int buildNodes(const std::vector<int>& split, int i, int j) const;
+  void assignSlots() const;
+  View view(int ref) const;
+  std::string describe(int ref) const;
+};
+
+S21MatrixChain operator*(S21MatrixChain chain, const S21Matrix& next);
+S21MatrixChain operator*(S21MatrixChain chain,
+                         const S21Matrix&& next) = delete;
+
+#endif
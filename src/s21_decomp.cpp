@@ -0,0 +1,586 @@
+#include "s21_decomp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "s21_cache.h"
+#include "s21_parallel.h"
+#include "s21_tuning.h"
+
+namespace s21 {
+
+namespace {
+
+// One-sided Jacobi stops once every column pair is orthogonal to this
+// relative accuracy, or after kMaxSweeps sweeps.
+constexpr double kJacobiTolerance = 1e-15;
+constexpr int kMaxSweeps = 60;
+
+void checkInitialized(const S21Matrix &a) {
+  if (a.GetRows() <= 0 || a.GetCols() <= 0) {
+    throw std::invalid_argument("ERROR: Matrix is not initialized");
+  }
+}
+
+// Applies H = I - 2 v v^T to rows [row0, rows) and columns [col0, cols) of
+// the row-major matrix `a` with leading dimension ld; v is indexed by row.
+// The columns are independent, so they are split across threads.
+void applyReflector(double *a, size_t ld, size_t row0, size_t rows,
+                    size_t col0, size_t cols, const double *v, double *w) {
+  auto update = [=](size_t first, size_t last) {
+    std::fill(w + first, w + last, 0.0);
+    for (size_t i = row0; i < rows; i++) {
+      const double *row = a + i * ld;
+      for (size_t c = first; c < last; c++) w[c] += v[i] * row[c];
+    }
+    for (size_t i = row0; i < rows; i++) {
+      double *row = a + i * ld;
+      const double scale = 2.0 * v[i];
+      for (size_t c = first; c < last; c++) row[c] -= scale * w[c];
+    }
+  };
+  const size_t height = rows - row0;
+  const Tunables &tuning = Tuning();
+  if (height * (cols - col0) < tuning.reflector_parallel_flops) {
+    update(col0, cols);
+  } else {
+    ParallelFor(col0, cols,
+                std::max<size_t>(1, tuning.parallel_grain / height), update);
+  }
+}
+
+S21Matrix leadingColumns(const S21Matrix &a, int cols) {
+  if (cols == a.GetCols()) return a;
+  S21Matrix result(a.GetRows(), cols, S21Matrix::uninitialized);
+  for (int i = 0; i < a.GetRows(); i++) {
+    std::copy_n(a.Row(i).data(), cols, result.Row(i).data());
+  }
+  return result;
+}
+
+S21Matrix leadingRows(const S21Matrix &a, int rows) {
+  if (rows == a.GetRows()) return a;
+  S21Matrix result(rows, a.GetCols(), S21Matrix::uninitialized);
+  std::copy_n(a.data(), result.size(), result.data());
+  return result;
+}
+
+// One-sided Jacobi SVD of the matrix whose columns are the rows of `w`
+// (count x length, row-major), for count <= length. Rotations make the rows
+// of w mutually orthogonal; w then holds U * diag(s) transposed and `v`
+// (count x count) accumulates V transposed.
+SvdResult jacobiSvd(S21Matrix w) {
+  const int count = w.GetRows();
+  const size_t length = w.GetCols();
+  S21Matrix v(count, count);
+  for (int i = 0; i < count; i++) v.At(i, i) = 1.0;
+  double *wd = w.data();
+  double *vd = v.data();
+
+  auto rotate = [](double *x, double *y, size_t size, double c, double s) {
+    for (size_t i = 0; i < size; i++) {
+      const double xi = x[i], yi = y[i];
+      x[i] = c * xi - s * yi;
+      y[i] = s * xi + c * yi;
+    }
+  };
+  for (int sweep = 0; sweep < kMaxSweeps; sweep++) {
+    ThrowIfCancelled();
+    bool rotated = false;
+    for (int p = 0; p < count - 1; p++) {
+      for (int q = p + 1; q < count; q++) {
+        double *wp = wd + p * length;
+        double *wq = wd + q * length;
+        double alpha = 0.0, beta = 0.0, gamma = 0.0;
+        for (size_t i = 0; i < length; i++) {
+          alpha += wp[i] * wp[i];
+          beta += wq[i] * wq[i];
+          gamma += wp[i] * wq[i];
+        }
+        if (gamma == 0.0 ||
+            std::fabs(gamma) <= kJacobiTolerance * std::sqrt(alpha * beta)) {
+          continue;
+        }
+        rotated = true;
+        const double zeta = (beta - alpha) / (2.0 * gamma);
+        const double t = std::copysign(1.0, zeta) /
+                         (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+        const double c = 1.0 / std::sqrt(1.0 + t * t);
+        const double s = c * t;
+        rotate(wp, wq, length, c, s);
+        rotate(vd + p * count, vd + q * count, count, c, s);
+      }
+    }
+    if (!rotated) break;
+  }
+
+  std::vector<double> norms(count);
+  for (int j = 0; j < count; j++) {
+    const double *row = wd + j * length;
+    norms[j] = std::sqrt(std::inner_product(row, row + length, row, 0.0));
+  }
+  std::vector<int> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&norms](int x, int y) { return norms[x] > norms[y]; });
+
+  SvdResult result{S21Matrix(static_cast<int>(length), count),
+                   std::vector<double>(count),
+                   S21Matrix(count, count, S21Matrix::uninitialized)};
+  double *u = result.u.data();
+  for (int k = 0; k < count; k++) {
+    const int j = order[k];
+    result.s[k] = norms[j];
+    if (norms[j] > 0.0) {
+      const double *row = wd + j * length;
+      for (size_t i = 0; i < length; i++) u[i * count + k] = row[i] / norms[j];
+    }
+    std::copy_n(vd + j * count, count, result.vt.Row(k).data());
+  }
+  return result;
+}
+
+// Reduces the symmetric n x n row-major matrix `a`, both triangles set, to
+// tridiagonal form T = Q^T A Q with Q = H_0 * ... * H_(n-3). d and e get the
+// diagonal and subdiagonal of T (e[n-1] = 0). H_k = I - tau[k] u u^T acts on
+// rows k+1.. with u = (1, a[k+2][k], ..., a[n-1][k]), left in column k.
+void tridiagonalize(double *a, size_t n, double *d, double *e, double *tau) {
+  std::vector<double> u(n), p(n);
+  for (size_t k = 0; k + 2 < n; k++) {
+    ThrowIfCancelled();
+    const size_t b = k + 1, m = n - b;
+    const double alpha = a[b * n + k];
+    double x_norm = 0.0;
+    for (size_t i = b + 1; i < n; i++) x_norm += a[i * n + k] * a[i * n + k];
+    x_norm = std::sqrt(x_norm);
+    if (x_norm == 0.0) {
+      tau[k] = 0.0;
+      e[k] = alpha;
+      continue;
+    }
+    const double beta = -std::copysign(std::hypot(alpha, x_norm), alpha);
+    tau[k] = (beta - alpha) / beta;
+    e[k] = beta;
+    u[0] = 1.0;
+    for (size_t i = 1; i < m; i++) {
+      a[(b + i) * n + k] /= alpha - beta;
+      u[i] = a[(b + i) * n + k];
+    }
+
+    // H A22 H = A22 - u w^T - w u^T with p = tau * A22 u and
+    // w = p - tau / 2 * (p . u) u.
+    double *block = a + b * n + b;
+    const double t = tau[k];
+    const Tunables &tuning = Tuning();
+    auto rows = [&](const auto &body) {
+      if (m * m < tuning.reflector_parallel_flops) {
+        body(size_t{0}, m);
+      } else {
+        ParallelFor(0, m, std::max<size_t>(1, tuning.parallel_grain / m), body);
+      }
+    };
+    rows([&](size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+        const double *row = block + i * n;
+        double sum = 0.0;
+        for (size_t j = 0; j < m; j++) sum += row[j] * u[j];
+        p[i] = t * sum;
+      }
+    });
+    const double half = 0.5 * t * std::inner_product(p.begin(), p.begin() + m,
+                                                     u.begin(), 0.0);
+    for (size_t i = 0; i < m; i++) p[i] -= half * u[i];
+    rows([&](size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+        double *row = block + i * n;
+        for (size_t j = 0; j < m; j++) row[j] -= u[i] * p[j] + p[i] * u[j];
+      }
+    });
+  }
+  for (size_t i = 0; i < n; i++) d[i] = a[i * n + i];
+  if (n >= 2) e[n - 2] = a[(n - 1) * n + n - 2];
+  e[n - 1] = 0.0;
+}
+
+// Overwrites `a` with Q^T = H_(n-3) * ... * H_0, built from the reflectors
+// tridiagonalize left in it. Working backwards, the product of the trailing
+// reflectors is the identity outside block [k+1.., k+1..], and that block
+// never overlaps the reflectors still to be applied.
+void formQt(double *a, size_t n, const double *tau) {
+  std::vector<double> u(n), w(n);
+  for (size_t k = n - 1; k-- > 0;) {
+    const size_t b = k + 1, m = n - b;
+    u[0] = 1.0;
+    for (size_t i = 1; i < m; i++) u[i] = a[(b + i) * n + k];
+    a[b * n + b] = 1.0;
+    for (size_t i = b + 1; i < n; i++) a[b * n + i] = a[i * n + b] = 0.0;
+    if (k + 2 >= n || tau[k] == 0.0) continue;
+
+    // R = R * H_k = R - tau (R u) u^T on the block.
+    double *block = a + b * n + b;
+    auto update = [&](size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+        double *row = block + i * n;
+        double sum = 0.0;
+        for (size_t j = 0; j < m; j++) sum += row[j] * u[j];
+        const double scale = tau[k] * sum;
+        for (size_t j = 0; j < m; j++) row[j] -= scale * u[j];
+      }
+    };
+    const Tunables &tuning = Tuning();
+    if (m * m < tuning.reflector_parallel_flops) {
+      update(0, m);
+    } else {
+      ParallelFor(0, m, std::max<size_t>(1, tuning.parallel_grain / m), update);
+    }
+  }
+  a[0] = 1.0;
+  for (size_t i = 1; i < n; i++) a[i] = a[i * n] = 0.0;
+}
+
+// Implicit-shift QL on the tridiagonal (d, e) (Numerical Recipes tqli).
+// Eigenvalues replace d. When `zt` is given its rows are rotated along, so
+// rows that start as Q^T end as the eigenvectors of A.
+void tridiagonalQl(double *d, double *e, size_t n, double *zt) {
+  constexpr int kMaxIterations = 60;
+  for (size_t l = 0; l < n; l++) {
+    int iterations = 0;
+    size_t m;
+    do {
+      for (m = l; m + 1 < n; m++) {
+        const double dd = std::fabs(d[m]) + std::fabs(d[m + 1]);
+        if (std::fabs(e[m]) <= std::numeric_limits<double>::epsilon() * dd) {
+          break;
+        }
+      }
+      if (m == l) break;
+      if (iterations++ == kMaxIterations) {
+        throw std::domain_error("ERROR: eigenvalue iteration did not converge");
+      }
+      double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+      double r = std::hypot(g, 1.0);
+      g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+      double s = 1.0, c = 1.0, p = 0.0;
+      bool underflow = false;
+      for (size_t i = m; i-- > l;) {
+        const double f = s * e[i], b = c * e[i];
+        r = std::hypot(f, g);
+        e[i + 1] = r;
+        if (r == 0.0) {
+          d[i + 1] -= p;
+          e[m] = 0.0;
+          underflow = true;
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + 2.0 * c * b;
+        p = s * r;
+        d[i + 1] = g + p;
+        g = c * r - b;
+        if (zt != nullptr) {
+          double *zi = zt + i * n;
+          double *zj = zt + (i + 1) * n;
+          for (size_t k = 0; k < n; k++) {
+            const double zf = zj[k];
+            zj[k] = s * zi[k] + c * zf;
+            zi[k] = c * zi[k] - s * zf;
+          }
+        }
+      }
+      if (underflow) continue;
+      d[l] -= p;
+      e[l] = g;
+      e[m] = 0.0;
+    } while (true);
+  }
+}
+
+// Solves (T - shift I) x = b in place for the tridiagonal T = (d, e) by
+// Gaussian elimination with partial pivoting (LAPACK dgttrf/dgttrs). Exactly
+// zero pivots are nudged to `tiny`, as inverse iteration wants.
+void shiftedTridiagonalSolve(const double *d, const double *e, size_t n,
+                             double shift, double tiny, double *x,
+                             std::vector<double> &work) {
+  work.assign(5 * n, 0.0);
+  double *dl = work.data(), *dd = dl + n, *du = dd + n, *du2 = du + n;
+  double *swapped = du2 + n;
+  for (size_t i = 0; i < n; i++) {
+    dd[i] = d[i] - shift;
+    if (i + 1 < n) dl[i] = du[i] = e[i];
+  }
+  for (size_t i = 0; i + 1 < n; i++) {
+    if (std::fabs(dd[i]) >= std::fabs(dl[i])) {
+      if (dd[i] == 0.0) dd[i] = tiny;
+      const double fact = dl[i] / dd[i];
+      dl[i] = fact;
+      dd[i + 1] -= fact * du[i];
+    } else {
+      const double fact = dd[i] / dl[i];
+      dd[i] = dl[i];
+      dl[i] = fact;
+      const double temp = du[i];
+      du[i] = dd[i + 1];
+      dd[i + 1] = temp - fact * dd[i + 1];
+      if (i + 2 < n) {
+        du2[i] = du[i + 1];
+        du[i + 1] = -fact * du[i + 1];
+      }
+      swapped[i] = 1.0;
+    }
+  }
+  if (dd[n - 1] == 0.0) dd[n - 1] = tiny;
+
+  for (size_t i = 0; i + 1 < n; i++) {
+    if (swapped[i] != 0.0) {
+      const double temp = x[i];
+      x[i] = x[i + 1];
+      x[i + 1] = temp - dl[i] * x[i];
+    } else {
+      x[i + 1] -= dl[i] * x[i];
+    }
+  }
+  for (size_t i = n; i-- > 0;) {
+    double sum = x[i];
+    if (i + 1 < n) sum -= du[i] * x[i + 1];
+    if (i + 2 < n) sum -= du2[i] * x[i + 2];
+    x[i] = sum / dd[i];
+  }
+}
+
+}  // namespace
+
+/* -------------- QR -------------- */
+
+namespace {
+
+QrResult householderQr(const S21Matrix &a) {
+  const size_t m = a.GetRows(), n = a.GetCols();
+  const size_t k = std::min(m, n);
+  S21Matrix r(a);
+  double *rd = r.data();
+  // Column j of `reflectors` holds the unit vector v_j (zero above row j);
+  // a zero column stands for H_j = I.
+  std::vector<double> reflectors(m * k, 0.0), v(m), w(std::max(m, n));
+
+  for (size_t j = 0; j < k; j++) {
+    ThrowIfCancelled();
+    double norm = 0.0;
+    for (size_t i = j; i < m; i++) norm += rd[i * n + j] * rd[i * n + j];
+    norm = std::sqrt(norm);
+    if (norm == 0.0) continue;
+    const double alpha = rd[j * n + j] >= 0.0 ? -norm : norm;
+    std::fill(v.begin(), v.end(), 0.0);
+    v[j] = rd[j * n + j] - alpha;
+    double v_norm = v[j] * v[j];
+    for (size_t i = j + 1; i < m; i++) {
+      v[i] = rd[i * n + j];
+      v_norm += v[i] * v[i];
+    }
+    v_norm = std::sqrt(v_norm);
+    if (v_norm == 0.0) continue;
+    for (size_t i = j; i < m; i++) {
+      v[i] /= v_norm;
+      reflectors[i * k + j] = v[i];
+    }
+    applyReflector(rd, n, j, m, j + 1, n, v.data(), w.data());
+    rd[j * n + j] = alpha;
+    for (size_t i = j + 1; i < m; i++) rd[i * n + j] = 0.0;
+  }
+
+  // Q = H_0 * ... * H_(k-1) applied to the first k columns of I.
+  S21Matrix q(static_cast<int>(m), static_cast<int>(k));
+  double *qd = q.data();
+  for (size_t i = 0; i < k; i++) qd[i * k + i] = 1.0;
+  for (size_t j = k; j-- > 0;) {
+    for (size_t i = 0; i < m; i++) v[i] = reflectors[i * k + j];
+    if (v[j] == 0.0) continue;
+    applyReflector(qd, k, j, m, 0, k, v.data(), w.data());
+  }
+  return {std::move(q), leadingRows(r, static_cast<int>(k))};
+}
+
+}  // namespace
+
+QrResult Qr(const S21Matrix &a) {
+  checkInitialized(a);
+  return ResultCache::Instance().GetOrCompute<QrResult>(
+      CachedOperation::kQr, a, [&a] { return householderQr(a); });
+}
+
+/* -------------- SVD -------------- */
+
+namespace {
+
+SvdResult thinSvd(const S21Matrix &a) {
+  if (a.GetRows() >= a.GetCols()) {
+    // Columns of A are the rows of A^T.
+    return jacobiSvd(a.Transpose());
+  }
+  // A^T = U' S V'^T, so A = V' S U'^T.
+  SvdResult t = jacobiSvd(a);
+  return {t.vt.Transpose(), std::move(t.s), t.u.Transpose()};
+}
+
+}  // namespace
+
+SvdResult Svd(const S21Matrix &a) {
+  checkInitialized(a);
+  return ResultCache::Instance().GetOrCompute<SvdResult>(
+      CachedOperation::kSvd, a, [&a] { return thinSvd(a); });
+}
+
+SvdResult RandomizedSvd(const S21Matrix &a, int rank,
+                        const RandomizedSvdOptions &options) {
+  checkInitialized(a);
+  const int m = a.GetRows(), n = a.GetCols();
+  if (rank <= 0 || rank > std::min(m, n)) {
+    throw std::invalid_argument("ERROR: rank must be in [1, min(rows, cols)]");
+  }
+  if (options.oversampling < 0 || options.power_iterations < 0) {
+    throw std::invalid_argument("ERROR: invalid randomized SVD options");
+  }
+  const int samples =
+      std::min(rank + options.oversampling, std::min(m, n));
+
+  std::mt19937_64 rng(options.seed);
+  std::normal_distribution<double> gaussian;
+  S21Matrix omega(n, samples, S21Matrix::uninitialized);
+  for (double &value : omega) value = gaussian(rng);
+
+  S21Matrix y, z;
+  S21Matrix::Gemm(1.0, a, omega, 0.0, y);
+  // The sketches are random, so they bypass the result cache.
+  S21Matrix q = householderQr(y).q;
+  for (int i = 0; i < options.power_iterations; i++) {
+    S21Matrix::Gemm(1.0, a, q, 0.0, z, true);
+    const S21Matrix q_t = householderQr(z).q;
+    S21Matrix::Gemm(1.0, a, q_t, 0.0, y);
+    q = householderQr(y).q;
+  }
+
+  // B = Q^T A is samples x n; A ~ Q B = (Q U_B) S Vt.
+  S21Matrix b;
+  S21Matrix::Gemm(1.0, q, a, 0.0, b, true);
+  SvdResult small = thinSvd(b);
+  S21Matrix u;
+  S21Matrix::Gemm(1.0, q, small.u, 0.0, u);
+
+  small.s.resize(rank);
+  return {leadingColumns(u, rank), std::move(small.s),
+          leadingRows(small.vt, rank)};
+}
+
+
+/* -------------- SYMMETRIC EIGENSOLVER -------------- */
+
+EigenResult SymmetricEigen(const S21Matrix &a, int top_k) {
+  checkInitialized(a);
+  return ResultCache::Instance().GetOrCompute<EigenResult>(
+      CachedOperation::kSymmetricEigen, a,
+      [&a, top_k] { return SymmetricEigen(S21Matrix(a), top_k); }, top_k);
+}
+
+EigenResult SymmetricEigen(S21Matrix &&a, int top_k) {
+  checkInitialized(a);
+  if (a.GetRows() != a.GetCols()) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+  const size_t n = a.GetRows();
+  if (top_k < 0 || top_k > a.GetRows()) {
+    throw std::invalid_argument("ERROR: top_k must be in [0, rows]");
+  }
+  const size_t k = top_k == 0 ? n : top_k;
+  double *data = a.data();
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < i; j++) data[j * n + i] = data[i * n + j];
+  }
+  std::vector<double> d(n), e(n), tau(n, 0.0);
+  tridiagonalize(data, n, d.data(), e.data(), tau.data());
+
+  EigenResult result;
+  if (k == n) {
+    formQt(data, n, tau.data());
+    tridiagonalQl(d.data(), e.data(), n, data);
+    // Selection sort on the rows of Q^T, then transpose in place.
+    for (size_t i = 0; i < n; i++) {
+      const size_t best = std::max_element(d.begin() + i, d.end()) - d.begin();
+      if (best != i) {
+        std::swap(d[i], d[best]);
+        std::swap_ranges(data + i * n, data + (i + 1) * n, data + best * n);
+      }
+    }
+    for (size_t i = 0; i < n; i++) {
+      for (size_t j = i + 1; j < n; j++) {
+        std::swap(data[i * n + j], data[j * n + i]);
+      }
+    }
+    result.values = std::move(d);
+    result.vectors = std::move(a);
+    return result;
+  }
+
+  std::vector<double> values(d), off(e);
+  tridiagonalQl(values.data(), off.data(), n, nullptr);
+  std::sort(values.begin(), values.end(), std::greater<double>());
+  values.resize(k);
+
+  double norm = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    norm = std::max(norm, std::fabs(d[i]) + std::fabs(e[i]) +
+                              (i > 0 ? std::fabs(e[i - 1]) : 0.0));
+  }
+  const double tiny =
+      std::numeric_limits<double>::epsilon() * std::max(norm, 1e-300);
+
+  // Inverse iteration on T; vectors of (nearly) equal eigenvalues are kept
+  // orthogonal by Gram-Schmidt against the ones already found.
+  std::vector<double> y(k * n), work;
+  std::mt19937_64 rng(0);
+  std::uniform_real_distribution<double> start(-1.0, 1.0);
+  for (size_t j = 0; j < k; j++) {
+    ThrowIfCancelled();
+    double *yj = &y[j * n];
+    for (size_t i = 0; i < n; i++) yj[i] = start(rng);
+    for (int iteration = 0; iteration < 3; iteration++) {
+      shiftedTridiagonalSolve(d.data(), e.data(), n, values[j], tiny, yj,
+                              work);
+      for (size_t p = 0; p < j; p++) {
+        const double *yp = &y[p * n];
+        const double overlap = std::inner_product(yj, yj + n, yp, 0.0);
+        for (size_t i = 0; i < n; i++) yj[i] -= overlap * yp[i];
+      }
+      const double length = std::sqrt(std::inner_product(yj, yj + n, yj, 0.0));
+      for (size_t i = 0; i < n; i++) yj[i] /= length;
+    }
+  }
+
+  // x = Q y = H_0 * (... * (H_(n-3) * y)).
+  S21Matrix vectors(static_cast<int>(n), static_cast<int>(k),
+                    S21Matrix::uninitialized);
+  double *out = vectors.data();
+  for (size_t j = 0; j < k; j++) {
+    double *yj = &y[j * n];
+    for (size_t r = n - 1; r-- > 0;) {
+      if (r + 2 >= n || tau[r] == 0.0) continue;
+      const size_t b = r + 1;
+      double dot = yj[b];
+      for (size_t i = b + 1; i < n; i++) dot += data[i * n + r] * yj[i];
+      const double scale = tau[r] * dot;
+      yj[b] -= scale;
+      for (size_t i = b + 1; i < n; i++) yj[i] -= scale * data[i * n + r];
+    }
+    for (size_t i = 0; i < n; i++) out[i * k + j] = yj[i];
+  }
+  result.values = std::move(values);
+  result.vectors = std::move(vectors);
+  return result;
+}
+
+}  // namespace s21
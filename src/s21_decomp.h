@@ -0,0 +1,69 @@
+#ifndef S21_DECOMP_H
+#define S21_DECOMP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Orthogonal decompositions of dense S21Matrix objects.
+namespace s21 {
+
+// Thin QR, A = Q * R with k = min(rows, cols): Q is rows x k with
+// orthonormal columns and R is k x cols upper triangular.
+struct QrResult {
+  S21Matrix q, r;
+};
+
+// Householder QR. Qr, Svd and the copying SymmetricEigen consult
+// s21::ResultCache when it is enabled.
+QrResult Qr(const S21Matrix& a);
+
+// Thin SVD, A = U * diag(s) * Vt with the singular values s in descending
+// order. For a k-term result U is rows x k and Vt is k x cols; columns of U
+// that belong to zero singular values are zero.
+struct SvdResult {
+  S21Matrix u;
+  std::vector<double> s;
+  S21Matrix vt;
+};
+
+// Full thin SVD by one-sided Jacobi rotations, accurate to working
+// precision. O(rows * cols * min(rows, cols)) per sweep.
+SvdResult Svd(const S21Matrix& a);
+
+struct RandomizedSvdOptions {
+  int oversampling = 10;     // extra sample columns beyond the rank
+  int power_iterations = 2;  // sharpen a slowly decaying spectrum
+  uint64_t seed = 0;         // mt19937_64 seed; equal seeds, equal results
+};
+
+// Rank-`rank` approximation by a randomized range finder (Halko, Martinsson
+// and Tropp): Q spans A * Omega for a Gaussian Omega with rank + oversampling
+// columns, refined by power iterations that re-orthonormalize through QR;
+// the small matrix Q^T * A is then decomposed with Svd. All large products
+// go through Gemm.
+SvdResult RandomizedSvd(const S21Matrix& a, int rank,
+                        const RandomizedSvdOptions& options = {});
+
+// Eigenpairs of a symmetric matrix, largest eigenvalue first; the columns
+// of `vectors` are the matching orthonormal eigenvectors.
+struct EigenResult {
+  std::vector<double> values;
+  S21Matrix vectors;
+};
+
+// Only the lower triangle of `a` is read. The matrix is reduced to
+// tridiagonal form by Householder reflections, whose rank-2 updates run on
+// the pool, and then diagonalized by implicit-shift QL. With top_k > 0 only
+// the top_k largest pairs are computed: all eigenvalues come from the cheap
+// value-only QL and the vectors from inverse iteration on the tridiagonal
+// matrix, skipping the O(n^3) accumulation of the full basis.
+EigenResult SymmetricEigen(const S21Matrix& a, int top_k = 0);
+// Same, working in the buffer of `a`: it holds the reflectors and then,
+// when every pair is requested, becomes `vectors` without being copied.
+EigenResult SymmetricEigen(S21Matrix&& a, int top_k = 0);
+
+}  // namespace s21
+
+#endif
@@ -1,21 +1,379 @@
 #include "s21_matrix.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_backend.h"
+#include "s21_cache.h"
+#include "s21_parallel.h"
+#include "s21_tuning.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define S21_HASH_X86 1
+#endif
+
+namespace {
+
+// Parallel cutoffs, see s21::Tunables.
+size_t parallelThreshold() { return s21::Tuning().parallel_threshold; }
+size_t parallelGrain() { return s21::Tuning().parallel_grain; }
+size_t adjugateParallelFlops() {
+  return s21::Tuning().adjugate_parallel_flops;
+}
+// Reductions sum fixed-size blocks so the result never depends on the
+// number of threads that happened to run them; for the same reason this
+// one is not tunable.
+constexpr size_t kReduceBlock = 4096;
+
+template <typename Body>
+void forEachChunk(size_t size, const Body &body) {
+  if (size < parallelThreshold()) {
+    body(size_t{0}, size);
+  } else {
+    s21::ParallelFor(0, size, parallelGrain(), body);
+  }
+}
+
+// Neumaier's variant of Kahan summation.
+struct CompensatedSum {
+  double sum = 0.0;
+  double comp = 0.0;
+
+  void Add(double x) {
+    const double t = sum + x;
+    if (std::fabs(sum) >= std::fabs(x)) {
+      comp += (sum - t) + x;
+    } else {
+      comp += (x - t) + sum;
+    }
+    sum = t;
+  }
+  double Value() const { return sum + comp; }
+};
+
+// Pairwise summation of the per-block partials, in block order.
+double pairwiseSum(const double *values, size_t count) {
+  if (count == 0) return 0.0;
+  if (count == 1) return values[0];
+  const size_t half = count / 2;
+  return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+}
+
+// Runs block_fn(first, last) over consecutive blocks of block_size indices of
+// [0, size) and returns one partial result per block, in block order.
+template <typename F>
+std::vector<double> blockPartials(size_t size, size_t block_size,
+                                  const F &block_fn) {
+  const size_t blocks = (size + block_size - 1) / block_size;
+  std::vector<double> partials(blocks);
+  auto body = [&](size_t first, size_t last) {
+    for (size_t block = first; block < last; block++) {
+      partials[block] = block_fn(block * block_size,
+                                 std::min(size, (block + 1) * block_size));
+    }
+  };
+  if (size < parallelThreshold()) {
+    body(0, blocks);
+  } else {
+    s21::ParallelFor(0, blocks, std::max<size_t>(1, parallelGrain() / block_size),
+                     body);
+  }
+  return partials;
+}
+
+// Deterministic compensated sum of f(i) for i in [0, size).
+template <typename F>
+double reduceSum(size_t size, const F &f) {
+  std::vector<double> partials =
+      blockPartials(size, kReduceBlock, [&f](size_t first, size_t last) {
+        CompensatedSum acc;
+        for (size_t i = first; i < last; i++) acc.Add(f(i));
+        return acc.Value();
+      });
+  return pairwiseSum(partials.data(), partials.size());
+}
+
+// Writes adj(a) (or its transpose, the cofactor matrix, when `cofactors` is
+// set) of the n x n row-major matrix `a` into `out` in O(n^3).
+//
+// With complete pivoting P * A * Q = L * U and only trailing pivots of U can
+// vanish, so U = [U1 u; 0 d] with U1 nonsingular whenever rank(A) >= n - 1.
+// Then adj(U) = [d * det(U1) * inv(U1), -det(U1) * inv(U1) * u; 0, det(U1)]
+// is well defined even for d == 0, and
+//   adj(A) = det(P) * det(Q) * Q * adj(U) * inv(L) * P.
+// If rank(A) <= n - 2 every (n-1)-minor vanishes and adj(A) = 0.
+void adjugate(const double *a, int n, double *out, bool cofactors) {
+  const size_t ld = n;
+  std::vector<double> lu(a, a + ld * n);
+  std::vector<int> p(n), q(n);
+  for (int i = 0; i < n; i++) p[i] = q[i] = i;
+  double sign = 1.0;
+  int rank = n;
+
+  for (int k = 0; k < n; k++) {
+    s21::ThrowIfCancelled();
+    int pr = k, pc = k;
+    for (int i = k; i < n; i++) {
+      for (int j = k; j < n; j++) {
+        if (std::fabs(lu[i * ld + j]) > std::fabs(lu[pr * ld + pc])) {
+          pr = i;
+          pc = j;
+        }
+      }
+    }
+    if (pr != k) {
+      std::swap_ranges(&lu[k * ld], &lu[k * ld] + n, &lu[pr * ld]);
+      std::swap(p[k], p[pr]);
+      sign = -sign;
+    }
+    if (pc != k) {
+      for (int i = 0; i < n; i++) std::swap(lu[i * ld + k], lu[i * ld + pc]);
+      std::swap(q[k], q[pc]);
+      sign = -sign;
+    }
+    const double pivot = lu[k * ld + k];
+    if (pivot == 0.0) {
+      rank = k;
+      break;
+    }
+    for (int i = k + 1; i < n; i++) {
+      double *row = &lu[i * ld];
+      const double ratio = row[k] / pivot;
+      row[k] = ratio;
+      for (int j = k + 1; j < n; j++) row[j] -= ratio * lu[k * ld + j];
+    }
+  }
+
+  std::fill(out, out + ld * n, 0.0);
+  if (rank < n - 1) return;
+
+  // x = adj(U), upper triangular. Rows of inv(U1) are built bottom-up; the
+  // column ranges are independent, so they are split across threads.
+  const int m = n - 1;
+  double det_u1 = 1.0;
+  for (int i = 0; i < m; i++) det_u1 *= lu[i * ld + i];
+  const double d = lu[m * ld + m];
+  std::vector<double> x(ld * n, 0.0);
+  auto invert_columns = [&](size_t first, size_t last) {
+    for (int i = m - 1; i >= 0; i--) {
+      const double *u_row = &lu[i * ld];
+      double *x_row = &x[i * ld];
+      for (size_t j = std::max<size_t>(first, i); j < last; j++) {
+        double sum = j == static_cast<size_t>(i) ? 1.0 : 0.0;
+        for (size_t t = i + 1; t <= j; t++) sum -= u_row[t] * x[t * ld + j];
+        x_row[j] = sum / u_row[i];
+      }
+    }
+  };
+  if (static_cast<size_t>(m) * m * m < adjugateParallelFlops()) {
+    invert_columns(0, m);
+  } else {
+    s21::ParallelFor(0, m, 16, invert_columns);
+  }
+  for (int i = 0; i < m; i++) {
+    // Last column: -det(U1) * inv(U1) * u, the rest scaled by d * det(U1).
+    double *x_row = &x[i * ld];
+    double dot = 0.0;
+    for (int t = i; t < m; t++) dot += x_row[t] * lu[t * ld + m];
+    for (int j = i; j < m; j++) x_row[j] *= d * det_u1;
+    x_row[m] = -det_u1 * dot;
+  }
+  x[m * ld + m] = det_u1;
+
+  // x = x * inv(L), row by row: row_x * L = row_adjU.
+  auto apply_inv_l = [&](size_t first, size_t last) {
+    for (size_t r = first; r < last; r++) {
+      double *x_row = &x[r * ld];
+      for (int t = n - 1; t > 0; t--) {
+        const double xt = x_row[t];
+        if (xt == 0.0) continue;
+        const double *l_row = &lu[t * ld];
+        for (int j = 0; j < t; j++) x_row[j] -= xt * l_row[j];
+      }
+    }
+  };
+  if (static_cast<size_t>(n) * n * n < adjugateParallelFlops()) {
+    apply_inv_l(0, n);
+  } else {
+    s21::ParallelFor(0, n, 16, apply_inv_l);
+  }
+
+  // adj(A)[q[i]][p[j]] = sign * x[i][j].
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      const double value = sign * x[i * ld + j];
+      if (cofactors) {
+        out[p[j] * ld + q[i]] = value;
+      } else {
+        out[q[i] * ld + p[j]] = value;
+      }
+    }
+  }
+}
+
+}  // namespace
 
 /* -------------- CONSTRUCTORS AND DESTRUCTORS -------------- */
 
-void S21Matrix::initMatrix() {
-  matrix_ = new double *[rows_];
-  for (int i = 0; i < rows_; i++) {
-    matrix_[i] = new double[cols_];
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] = 0.0;
+namespace {
+
+std::atomic<bool> copy_on_write{false};
+std::atomic<bool> huge_pages{false};
+
+// Transparent huge pages are 2 MiB on x86-64 and most aarch64 kernels.
+constexpr size_t kHugePageSize = size_t{1} << 21;
+constexpr size_t kPageDoubles = 4096 / sizeof(double);
+
+// Zeroes a freshly allocated block. Large blocks are cleared by the pool in
+// page-aligned slices, so under the kernel's first-touch policy their pages
+// are spread across the nodes of the pool's threads instead of all landing
+// on the constructing thread's node. Chunks are claimed dynamically and
+// workers are not pinned, so this only spreads the pages; it does not place
+// them next to the thread that later computes on them.
+void firstTouchZero(double *data, size_t size) {
+  if (size < parallelThreshold()) {
+    std::fill(data, data + size, 0.0);
+    return;
+  }
+  const size_t pages = (size + kPageDoubles - 1) / kPageDoubles;
+  s21::ParallelFor(0, pages,
+                   std::max<size_t>(1, parallelGrain() / kPageDoubles),
+                   [data, size](size_t first, size_t last) {
+                     std::fill(data + first * kPageDoubles,
+                               data + std::min(size, last * kPageDoubles), 0.0);
+                   });
+}
+
+}  // namespace
+
+S21Matrix::Buffer *S21Matrix::allocateBuffer(size_t size) {
+  const size_t bytes = sizeof(Buffer) + sizeof(double) * size;
+  if (bytes >= kHugePageSize && HugePages()) {
+    const size_t rounded = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (void *raw = std::aligned_alloc(kHugePageSize, rounded)) {
+#ifdef MADV_HUGEPAGE
+      madvise(raw, rounded, MADV_HUGEPAGE);
+#endif
+      return new (raw) Buffer{1, true};
+    }
+  }
+  void *raw = ::operator new(bytes);
+  return new (raw) Buffer{1, false};
+}
+
+void S21Matrix::releaseBuffer(Buffer *buffer) noexcept {
+  if (buffer != nullptr &&
+      buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    const bool huge = buffer->huge;
+    buffer->~Buffer();
+    if (huge) {
+      std::free(buffer);
+    } else {
+      ::operator delete(buffer);
     }
   }
 }
 
-S21Matrix::S21Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
+void S21Matrix::adoptBuffer(Buffer *buffer) noexcept {
+  releaseBuffer(buffer_);
+  buffer_ = buffer;
+  matrix_ = buffer->data();
+}
+
+// Drops the heap buffer, if any, and points the elements at inline_.
+void S21Matrix::useInline() noexcept {
+  releaseBuffer(buffer_);
+  buffer_ = nullptr;
+  matrix_ = inline_;
+}
+
+// Moves the storage of `other` into this matrix, which holds none, and
+// leaves `other` empty. Inline elements are copied, heap buffers stolen.
+void S21Matrix::takeStorage(S21Matrix &other) noexcept {
+  rows_ = other.rows_;
+  cols_ = other.cols_;
+  if (other.matrix_ == other.inline_) {
+    matrix_ = inline_;
+    std::memcpy(inline_, other.inline_, sizeof(double) * size());
+  } else {
+    matrix_ = other.matrix_;
+    buffer_ = other.buffer_;
+  }
+  hash_.store(other.hash_.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+  writable_ = other.writable_;
+  other.clearMatrix();
+}
+
+void S21Matrix::initMatrix(bool zero_fill) {
+  const size_t size = static_cast<size_t>(rows_) * cols_;
+  if (size <= kInlineCapacity) {
+    matrix_ = inline_;
+    if (zero_fill) std::fill(inline_, inline_ + size, 0.0);
+    return;
+  }
+  buffer_ = allocateBuffer(size);
+  matrix_ = buffer_->data();
+  if (zero_fill) firstTouchZero(matrix_, size);
+}
+
+void S21Matrix::freeMatrix() noexcept {
+  releaseBuffer(buffer_);
+  buffer_ = nullptr;
+  matrix_ = nullptr;
+}
+
+// Slow path of prepareWrite: drops the cached hash and detaches shared
+// storage.
+void S21Matrix::makeWritable() {
+  hash_.store(0, std::memory_order_relaxed);
+  if (buffer_ != nullptr &&
+      buffer_->refs.load(std::memory_order_acquire) > 1) {
+    detach(true);
+  }
+  writable_ = true;
+}
+
+void S21Matrix::detach(bool keep_contents) {
+  const size_t size = static_cast<size_t>(rows_) * cols_;
+  Buffer *fresh = allocateBuffer(size);
+  if (keep_contents) {
+    std::memcpy(fresh->data(), matrix_, sizeof(double) * size);
+  }
+  adoptBuffer(fresh);
+}
+
+// Gives the matrix private storage for rows * cols elements: the inline
+// array when they fit, otherwise a heap buffer, reusing the current one when
+// it is unshared and already has that many elements. The contents are
+// unspecified afterwards; callers overwrite them.
+void S21Matrix::reshape(int rows, int cols) {
+  const size_t size = static_cast<size_t>(rows) * cols;
+  hash_.store(0, std::memory_order_relaxed);
+  if (size <= kInlineCapacity) {
+    useInline();
+  } else if (buffer_ == nullptr || size != static_cast<size_t>(rows_) * cols_ ||
+             buffer_->refs.load(std::memory_order_acquire) > 1) {
+    adoptBuffer(allocateBuffer(size));
+  }
+  rows_ = rows;
+  cols_ = cols;
+}
+
+S21Matrix::S21Matrix(int rows, int cols)
+    : rows_(rows), cols_(cols), matrix_(nullptr), buffer_(nullptr) {
   if (rows_ <= 0 || cols_ <= 0) {
     throw std::domain_error(
         "ERROR: Rows and columns must be greater than zero");
@@ -25,41 +383,80 @@ S21Matrix::S21Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
   initMatrix();
 }
 
-void S21Matrix::copyMatrix(const S21Matrix &other) {
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] = other.matrix_[i][j];
-    }
+S21Matrix::S21Matrix(int rows, int cols, uninitialized_t)
+    : rows_(rows), cols_(cols), matrix_(nullptr), buffer_(nullptr) {
+  if (rows_ <= 0 || cols_ <= 0) {
+    throw std::domain_error(
+        "ERROR: Rows and columns must be greater than zero");
   }
+  initMatrix(false);
+}
+
+void S21Matrix::copyMatrix(const S21Matrix &other) {
+  std::memcpy(matrix_, other.matrix_,
+              sizeof(double) * static_cast<size_t>(rows_) * cols_);
 }
 
-S21Matrix::S21Matrix() noexcept : rows_(0), cols_(0), matrix_(nullptr) {}
+S21Matrix::S21Matrix() noexcept
+    : rows_(0), cols_(0), matrix_(nullptr), buffer_(nullptr) {}
 
 S21Matrix::S21Matrix(const S21Matrix &other)
-    : rows_(other.rows_), cols_(other.cols_) {
-  initMatrix();
-  copyMatrix(other);
+    : S21Matrix(other, CopyOnWrite()) {}
+
+S21Matrix::S21Matrix(const S21Matrix &other, bool share)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      matrix_(nullptr),
+      buffer_(nullptr) {
+  if (other.matrix_ == nullptr) return;
+  if (share && other.buffer_ != nullptr) {
+    other.buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+    other.clearWritable();
+    buffer_ = other.buffer_;
+    matrix_ = other.matrix_;
+  } else {
+    initMatrix(false);
+    copyMatrix(other);
+  }
+  hash_.store(other.hash_.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
 }
 
 void S21Matrix::clearMatrix() {
   rows_ = 0;
   cols_ = 0;
   matrix_ = nullptr;
+  buffer_ = nullptr;
+  hash_.store(0, std::memory_order_relaxed);
 }
 
 // Move constructor
 S21Matrix::S21Matrix(S21Matrix &&other) noexcept
-    : rows_(other.rows_), cols_(other.cols_), matrix_(other.matrix_) {
-  other.clearMatrix();
+    : rows_(0), cols_(0), matrix_(nullptr), buffer_(nullptr) {
+  takeStorage(other);
 }
 
-S21Matrix::~S21Matrix() noexcept {
-  if (matrix_ != nullptr) {
-    for (int i = 0; i < rows_; i++) {
-      delete[] matrix_[i];
-    }
-    delete[] matrix_;
-  }
+S21Matrix::~S21Matrix() noexcept { freeMatrix(); }
+
+void S21Matrix::SetCopyOnWrite(bool enabled) noexcept {
+  copy_on_write.store(enabled, std::memory_order_relaxed);
+}
+
+bool S21Matrix::CopyOnWrite() noexcept {
+  return copy_on_write.load(std::memory_order_relaxed);
+}
+
+bool S21Matrix::IsShared() const noexcept {
+  return buffer_ != nullptr &&
+         buffer_->refs.load(std::memory_order_acquire) > 1;
+}
+
+void S21Matrix::SetHugePages(bool enabled) noexcept {
+  huge_pages.store(enabled, std::memory_order_relaxed);
+}
+
+bool S21Matrix::HugePages() noexcept {
+  return huge_pages.load(std::memory_order_relaxed);
 }
 
 /* -------------- CONSTRUCTORS AND DESTRUCTORS -------------- */
@@ -69,15 +466,16 @@ void S21Matrix::SetRows(int new_rows) {
     throw std::invalid_argument("Number of rows must be greater than zero");
   }
 
-  if (matrix_ != nullptr) {
-    for (int i = 0; i < rows_; ++i) {
-      delete[] matrix_[i];
-    }
-    delete[] matrix_;
+  if (matrix_ == nullptr) {
+    throw std::logic_error("Matrix is not initialized");
   }
 
-  rows_ = new_rows;
-  initMatrix();
+  // The new storage may be inline or on the heap independently of the old.
+  const size_t keep = static_cast<size_t>(std::min(rows_, new_rows)) * cols_;
+  S21Matrix resized(new_rows, cols_, uninitialized);
+  std::memcpy(resized.matrix_, matrix_, sizeof(double) * keep);
+  std::fill(resized.matrix_ + keep, resized.matrix_ + resized.size(), 0.0);
+  *this = std::move(resized);
 }
 
 void S21Matrix::SetCols(int new_cols) {
@@ -89,16 +487,15 @@ void S21Matrix::SetCols(int new_cols) {
     throw std::logic_error("Matrix is not initialized");
   }
 
+  S21Matrix resized(rows_, new_cols, uninitialized);
+  const int keep = std::min(cols_, new_cols);
   for (int i = 0; i < rows_; ++i) {
-    double *new_row = new double[new_cols];
-    for (int j = 0; j < std::min(cols_, new_cols); ++j) {
-      new_row[j] = matrix_[i][j];
-    }
-    delete[] matrix_[i];
-    matrix_[i] = new_row;
+    double *row = resized.matrix_ + static_cast<size_t>(i) * new_cols;
+    std::memcpy(row, matrix_ + static_cast<size_t>(i) * cols_,
+                sizeof(double) * keep);
+    std::fill(row + keep, row + new_cols, 0.0);
   }
-
-  cols_ = new_cols;
+  *this = std::move(resized);
 }
 
 int S21Matrix::GetRows() const noexcept { return rows_; }
@@ -107,11 +504,13 @@ int S21Matrix::GetCols() const noexcept { return cols_; }
 
 void S21Matrix::PrintMatrix() const {
   for (int i = 0; i < rows_; ++i) {
+    const double *row = matrix_ + static_cast<size_t>(i) * cols_;
     for (int j = 0; j < cols_; ++j) {
-      std::cout << matrix_[i][j] << " ";
+      std::cout << row[j] << " ";
     }
-    std::cout << std::endl;
+    std::cout << '\n';
   }
+  std::cout.flush();
 }
 
 /* -------------- OPERATORS -------------- */
@@ -120,7 +519,32 @@ double &S21Matrix::operator()(int row, int col) {
   if (row >= rows_ || col >= cols_ || row < 0 || col < 0) {
     throw std::domain_error("ERROR: segmentation fault");
   }
-  return matrix_[row][col];
+  prepareWrite();
+  return matrix_[static_cast<size_t>(row) * cols_ + col];
+}
+
+const double &S21Matrix::operator()(int row, int col) const {
+  if (row >= rows_ || col >= cols_ || row < 0 || col < 0) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return matrix_[static_cast<size_t>(row) * cols_ + col];
+}
+
+std::span<double> S21Matrix::Row(int i) {
+  if (i < 0 || i >= rows_) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  prepareWrite();
+  return {matrix_ + static_cast<size_t>(i) * cols_,
+          static_cast<size_t>(cols_)};
+}
+
+std::span<const double> S21Matrix::Row(int i) const {
+  if (i < 0 || i >= rows_) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return {matrix_ + static_cast<size_t>(i) * cols_,
+          static_cast<size_t>(cols_)};
 }
 
 S21Matrix &S21Matrix::operator+=(const S21Matrix &other) {
@@ -162,27 +586,41 @@ S21Matrix &S21Matrix::operator=(const S21Matrix &other) {
     return *this;
   }
 
-  if (matrix_) {
-    for (int i = 0; i < rows_; ++i) {
-      delete[] matrix_[i];
-    }
-    delete[] matrix_;
-    matrix_ = nullptr;
+  if (other.matrix_ == nullptr) {
+    freeMatrix();
+    clearMatrix();
+    return *this;
   }
 
-  rows_ = other.rows_;
-  cols_ = other.cols_;
-
-  matrix_ = new double *[rows_];
-  for (int i = 0; i < rows_; ++i) {
-    matrix_[i] = new double[cols_];
-    std::memcpy(matrix_[i], other.matrix_[i], sizeof(double) * cols_);
+  if (CopyOnWrite() && other.buffer_ != nullptr) {
+    other.buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+    other.clearWritable();
+    releaseBuffer(buffer_);
+    buffer_ = other.buffer_;
+    matrix_ = other.matrix_;
+    rows_ = other.rows_;
+    cols_ = other.cols_;
+  } else {
+    // Reuses the current heap buffer when the element count already matches.
+    reshape(other.rows_, other.cols_);
+    copyMatrix(other);
   }
+  hash_.store(other.hash_.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+  writable_ = false;
 
   return *this;
 }
 
-bool S21Matrix::operator==(const S21Matrix &other) {
+S21Matrix &S21Matrix::operator=(S21Matrix &&other) noexcept {
+  if (this != &other) {
+    freeMatrix();
+    takeStorage(other);
+  }
+  return *this;
+}
+
+bool S21Matrix::operator==(const S21Matrix &other) const {
   return this->EqMatrix(other);
 }
 
@@ -194,157 +632,681 @@ void S21Matrix::SumMatrix(const S21Matrix &other) {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("ERROR: invalid");
   }
+  prepareWrite();
 
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] += other.matrix_[i][j];
-    }
-  }
+  double *data = matrix_;
+  const double *src = other.matrix_;
+  forEachChunk(static_cast<size_t>(rows_) * cols_,
+               [data, src](size_t first, size_t last) {
+                 for (size_t i = first; i < last; i++) data[i] += src[i];
+               });
 }
 
 void S21Matrix::SubMatrix(const S21Matrix &other) {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("ERROR: invalid");
   }
+  prepareWrite();
 
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] -= other.matrix_[i][j];
-    }
-  }
+  double *data = matrix_;
+  const double *src = other.matrix_;
+  forEachChunk(static_cast<size_t>(rows_) * cols_,
+               [data, src](size_t first, size_t last) {
+                 for (size_t i = first; i < last; i++) data[i] -= src[i];
+               });
 }
 
 void S21Matrix::MulNumber(const double num) {
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] *= num;
-    }
-  }
+  prepareWrite();
+  double *data = matrix_;
+  forEachChunk(static_cast<size_t>(rows_) * cols_,
+               [data, num](size_t first, size_t last) {
+                 for (size_t i = first; i < last; i++) data[i] *= num;
+               });
 }
 
 void S21Matrix::MulMatrix(const S21Matrix &other) {
-  if (cols_ != other.rows_ || rows_ != other.cols_) {
+  if (cols_ != other.rows_) {
     throw std::invalid_argument("ERROR");
   }
-  S21Matrix result(rows_, other.cols_);
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < other.cols_; j++) {
-      result.matrix_[i][j] = 0.0;
-      for (int k = 0; k < cols_; k++)
-        result.matrix_[i][j] += matrix_[i][k] * other.matrix_[k][j];
-    }
-  }
-  *this = result;
+  S21Matrix result(rows_, other.cols_, uninitialized);
+  Gemm(1.0, *this, other, 0.0, result);
+  *this = std::move(result);
 }
 
-S21Matrix S21Matrix::Transpose() {
-  S21Matrix result(cols_, rows_);
-  for (int i = 0; i < cols_; i++) {
-    for (int j = 0; j < rows_; j++) {
-      result.matrix_[i][j] = matrix_[j][i];
-    }
-  }
+S21Matrix S21Matrix::Transpose() const {
+  S21Matrix result(cols_, rows_, uninitialized);
+  s21::CurrentBackend().Transpose(rows_, cols_, matrix_, result.matrix_);
   return result;
 }
 
-double S21Matrix::Determinant() {
+double S21Matrix::Determinant() const {
   if (rows_ <= 0 || cols_ <= 0 || rows_ != cols_) {
     throw std::invalid_argument("ERROR");
   }
-  double det = 1.0;
-  if (rows_ == 1) {
-    det = matrix_[0][0];
-  } else if (rows_ == 2) {
-    det = matrix_[0][0] * matrix_[1][1] - matrix_[1][0] * matrix_[0][1];
-  } else {
-    for (int k = 0; k < rows_; k++) {
-      int max_row = k;
-      for (int i = k + 1; i < cols_; i++) {
-        if (fabs(matrix_[i][k]) > fabs(matrix_[max_row][k])) {
-          max_row = i;
-        }
-      }
-      if (max_row != k) {
-        for (int j = 0; j < rows_; j++) {
-          double temp = matrix_[k][j];
-          matrix_[k][j] = matrix_[max_row][j];
-          matrix_[max_row][j] = temp;
-        }
-        det *= -1;
-      }
-      det *= matrix_[k][k];
+  const double *a = matrix_;
+  if (rows_ == 1) return a[0];
+  if (rows_ == 2) return a[0] * a[3] - a[2] * a[1];
 
-      for (int i = k + 1; i < rows_; i++) {
-        double ratio = matrix_[i][k] / matrix_[k][k];
-        for (int j = k; j < cols_; j++) {
-          matrix_[i][j] -= ratio * matrix_[k][j];
-        }
-      }
-    }
+  return s21::ResultCache::Instance().GetOrCompute<double>(
+      s21::CachedOperation::kDeterminant, *this, [this] {
+        S21Matrix lu(*this);
+        std::vector<int> pivots(rows_);
+        return s21::CurrentBackend().LuFactor(rows_, lu.data(), rows_,
+                                              pivots.data());
+      });
+}
+
+S21Matrix S21Matrix::CalcComplements() const {
+  if (cols_ <= 0 || rows_ <= 0 || rows_ != cols_) {
+    throw std::invalid_argument(
+        "ERROR: Rows and columns must be greater than zero and matrix must be "
+        "square.");
   }
-  return det;
+
+  return s21::ResultCache::Instance().GetOrCompute<S21Matrix>(
+      s21::CachedOperation::kComplements, *this, [this] {
+        S21Matrix result(rows_, cols_, uninitialized);
+        adjugate(matrix_, rows_, result.matrix_, true);
+        return result;
+      });
 }
 
-S21Matrix S21Matrix::CalcComplements() {
+S21Matrix S21Matrix::Adjugate() const {
   if (cols_ <= 0 || rows_ <= 0 || rows_ != cols_) {
     throw std::invalid_argument(
         "ERROR: Rows and columns must be greater than zero and matrix must be "
         "square.");
   }
 
-  S21Matrix result(rows_, cols_);
-  S21Matrix minor(rows_ - 1, cols_ - 1);
+  S21Matrix result(rows_, cols_, uninitialized);
+  adjugate(matrix_, rows_, result.matrix_, false);
+  return result;
+}
 
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      int mi = 0;
-      for (int m = 0; m < rows_; m++) {
-        if (m == i) {
-          continue;
+bool S21Matrix::EqMatrix(const S21Matrix &other) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+  const double *lhs = matrix_;
+  const double *rhs = other.matrix_;
+  std::atomic<bool> equal(true);
+  forEachChunk(static_cast<size_t>(rows_) * cols_,
+               [lhs, rhs, &equal](size_t first, size_t last) {
+                 for (size_t i = first; i < last && equal.load(std::memory_order_relaxed);
+                      i++) {
+                   if (std::fabs(lhs[i] - rhs[i]) >= 1e-7) equal = false;
+                 }
+               });
+  return equal;
+}
+
+S21Matrix S21Matrix::InverseMatrix() const {
+  if (rows_ <= 0 || cols_ <= 0 || rows_ != cols_) {
+    throw std::invalid_argument("ERROR");
+  }
+  return s21::ResultCache::Instance().GetOrCompute<S21Matrix>(
+      s21::CachedOperation::kInverse, *this, [this] {
+        const s21::Backend &backend = s21::CurrentBackend();
+        S21Matrix lu(*this);
+        std::vector<int> pivots(rows_);
+        if (backend.LuFactor(rows_, lu.data(), rows_, pivots.data()) == 0.0) {
+          throw std::invalid_argument(
+              "ERROR: The determinant of this matrix is 0. The inverse matrix "
+              "does not exist.");
+        }
+        S21Matrix result(rows_, cols_);
+        for (int i = 0; i < rows_; i++) {
+          result.matrix_[static_cast<size_t>(i) * cols_ + i] = 1.0;
         }
-        int mj = 0;
-        for (int n = 0; n < cols_; n++) {
-          if (n == j) {
-            continue;
-          }
-          minor.matrix_[mi][mj] = matrix_[m][n];
-          mj++;
+        backend.LuSolve(rows_, cols_, lu.matrix_, rows_, pivots.data(),
+                        result.matrix_, cols_);
+        return result;
+      });
+}
+
+/* -------------- FUNCTIONS -------------- */
+
+/* -------------- BLAS-STYLE FUSED OPERATIONS -------------- */
+
+void S21Matrix::Gemm(double alpha, const S21Matrix &a, const S21Matrix &b,
+                     double beta, S21Matrix &c, bool trans_a, bool trans_b) {
+  const int m = trans_a ? a.cols_ : a.rows_;
+  const int k = trans_a ? a.rows_ : a.cols_;
+  const int kb = trans_b ? b.cols_ : b.rows_;
+  const int n = trans_b ? b.rows_ : b.cols_;
+  if (a.matrix_ == nullptr || b.matrix_ == nullptr || k != kb) {
+    throw std::invalid_argument("ERROR: Gemm operand shapes do not match");
+  }
+  if (&c == &a || &c == &b) {
+    // The output aliases an operand: compute out of place, then adopt.
+    S21Matrix result(c);
+    Gemm(alpha, a, b, beta, result, trans_a, trans_b);
+    c = std::move(result);
+    return;
+  }
+  if (c.rows_ != m || c.cols_ != n || c.matrix_ == nullptr) {
+    if (beta != 0.0) {
+      throw std::invalid_argument("ERROR: Gemm output has the wrong shape");
+    }
+    c.reshape(m, n);
+  } else if (c.IsShared()) {
+    c.detach(beta != 0.0);
+  }
+
+  c.hash_.store(0, std::memory_order_relaxed);
+  s21::CurrentBackend().Gemm(trans_a, trans_b, m, n, k, alpha, a.matrix_,
+                             a.cols_, b.matrix_, b.cols_, beta, c.matrix_, n);
+}
+
+void S21Matrix::Syrk(double alpha, const S21Matrix &a, double beta,
+                     S21Matrix &c, bool trans) {
+  const int n = trans ? a.cols_ : a.rows_;
+  const int k = trans ? a.rows_ : a.cols_;
+  if (a.matrix_ == nullptr) {
+    throw std::invalid_argument("ERROR: Syrk operand is empty");
+  }
+  if (&c == &a) {
+    S21Matrix result(c);
+    Syrk(alpha, a, beta, result, trans);
+    c = std::move(result);
+    return;
+  }
+  if (c.rows_ != n || c.cols_ != n || c.matrix_ == nullptr) {
+    if (beta != 0.0) {
+      throw std::invalid_argument("ERROR: Syrk output has the wrong shape");
+    }
+    c.reshape(n, n);
+  } else if (c.IsShared()) {
+    c.detach(beta != 0.0);
+  }
+
+  c.hash_.store(0, std::memory_order_relaxed);
+  s21::CurrentBackend().Syrk(trans, n, k, alpha, a.matrix_, a.cols_, beta,
+                             c.matrix_, n);
+  // Mirror the lower triangle tile by tile, like Transpose.
+  const int tile = static_cast<int>(
+      std::min<size_t>(s21::Tuning().transpose_tile, static_cast<size_t>(n)));
+  double *data = c.matrix_;
+  const size_t ld = n;
+  for (int i0 = 0; i0 < n; i0 += tile) {
+    const int i1 = std::min(n, i0 + tile);
+    for (int j0 = 0; j0 <= i0; j0 += tile) {
+      const int j1 = std::min(n, j0 + tile);
+      for (int i = i0; i < i1; i++) {
+        for (int j = j0; j < std::min(i, j1); j++) {
+          data[j * ld + i] = data[i * ld + j];
         }
-        mi++;
       }
-      double minor_det = minor.Determinant();
-      result(i, j) = minor_det * std::pow(-1, (i + j));
     }
   }
+}
+
+S21Matrix S21Matrix::Gram(bool trans) const {
+  S21Matrix result;
+  Syrk(1.0, *this, 0.0, result, trans);
   return result;
 }
 
-bool S21Matrix::EqMatrix(const S21Matrix &other) {
+void S21Matrix::Axpy(double alpha, const S21Matrix &x) {
+  ScaleAdd(1.0, alpha, x);
+}
+
+void S21Matrix::ScaleAdd(double scale, double alpha, const S21Matrix &x) {
+  if (rows_ != x.rows_ || cols_ != x.cols_) {
+    throw std::invalid_argument("ERROR: invalid");
+  }
+  prepareWrite();
+  double *data = matrix_;
+  const double *src = x.matrix_;
+  forEachChunk(static_cast<size_t>(rows_) * cols_,
+               [=](size_t first, size_t last) {
+                 for (size_t i = first; i < last; i++) {
+                   data[i] = scale * data[i] + alpha * src[i];
+                 }
+               });
+}
+
+/* -------------- BLAS-STYLE FUSED OPERATIONS -------------- */
+
+/* -------------- ELEMENT-WISE OPERATIONS -------------- */
+
+void S21Matrix::forChunks(size_t count, size_t cost,
+                          const std::function<void(size_t, size_t)> &body) {
+  cost = std::max<size_t>(cost, 1);
+  if (count * cost < parallelThreshold()) {
+    body(0, count);
+  } else {
+    s21::ParallelFor(0, count, std::max<size_t>(1, parallelGrain() / cost),
+                     body);
+  }
+}
+
+void S21Matrix::checkSameSize(const S21Matrix &other) const {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
-    return false;
+    throw std::invalid_argument("ERROR: matrices must have the same size");
+  }
+}
+
+S21Matrix S21Matrix::sameShape() const {
+  if (matrix_ == nullptr) return S21Matrix();
+  return S21Matrix(rows_, cols_, uninitialized);
+}
+
+void S21Matrix::HadamardMul(const S21Matrix &other) {
+  ZipWithInPlace([](double x, double y) { return x * y; }, other);
+}
+
+void S21Matrix::HadamardDiv(const S21Matrix &other) {
+  ZipWithInPlace([](double x, double y) { return x / y; }, other);
+}
+
+S21Matrix S21Matrix::HadamardProduct(const S21Matrix &other) const {
+  return ZipWith([](double x, double y) { return x * y; }, other);
+}
+
+S21Matrix S21Matrix::HadamardQuotient(const S21Matrix &other) const {
+  return ZipWith([](double x, double y) { return x / y; }, other);
+}
+
+void S21Matrix::AddRow(const S21Matrix &row) {
+  ZipWithRow([](double x, double y) { return x + y; }, row);
+}
+
+void S21Matrix::MulRow(const S21Matrix &row) {
+  ZipWithRow([](double x, double y) { return x * y; }, row);
+}
+
+void S21Matrix::AddColumn(const S21Matrix &column) {
+  ZipWithColumn([](double x, double y) { return x + y; }, column);
+}
+
+void S21Matrix::MulColumn(const S21Matrix &column) {
+  ZipWithColumn([](double x, double y) { return x * y; }, column);
+}
+
+/* -------------- ELEMENT-WISE OPERATIONS -------------- */
+
+/* -------------- LINEAR SOLVERS AND MATRIX FUNCTIONS -------------- */
+
+S21Matrix S21Matrix::Solve(const S21Matrix &b) const {
+  if (rows_ <= 0 || rows_ != cols_ || b.rows_ != rows_) {
+    throw std::invalid_argument("ERROR: Solve needs a square A and matching B");
+  }
+  S21Matrix lu(*this);
+  std::vector<int> pivots(rows_);
+  const s21::Backend &backend = s21::CurrentBackend();
+  if (backend.LuFactor(rows_, lu.data(), rows_, pivots.data()) == 0.0) {
+    throw std::invalid_argument("ERROR: the matrix is singular");
+  }
+  S21Matrix x(b);
+  backend.LuSolve(rows_, x.cols_, lu.matrix_, rows_, pivots.data(), x.data(),
+                  x.cols_);
+  return x;
+}
+
+S21Matrix S21Matrix::Pow(int k) const {
+  if (rows_ <= 0 || rows_ != cols_) {
+    throw std::invalid_argument("ERROR: matrix must be square");
   }
+  S21Matrix base = k < 0 ? InverseMatrix() : *this;
+  unsigned long exponent =
+      k < 0 ? -static_cast<unsigned long>(k) : static_cast<unsigned long>(k);
+
+  S21Matrix result(rows_, cols_);
+  for (int i = 0; i < rows_; i++) result.At(i, i) = 1.0;
+  // Square-and-multiply; products land in `scratch` and are swapped in, so
+  // only these three buffers are ever allocated.
+  S21Matrix scratch(rows_, cols_, uninitialized);
+  bool first = true;
+  while (exponent > 0) {
+    if (exponent & 1) {
+      if (first) {
+        result = base;
+        first = false;
+      } else {
+        Gemm(1.0, result, base, 0.0, scratch);
+        std::swap(result, scratch);
+      }
+    }
+    exponent >>= 1;
+    if (exponent > 0) {
+      Gemm(1.0, base, base, 0.0, scratch);
+      std::swap(base, scratch);
+    }
+  }
+  return result;
+}
+
+S21Matrix S21Matrix::Exp() const {
+  if (rows_ <= 0 || rows_ != cols_) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+  // Diagonal Pade approximant of degree 6 with scaling and squaring
+  // (Golub & Van Loan, Algorithm 11.3.1): scale A so that ||A|| <= 1/2,
+  // evaluate N(A), D(A), solve D * F = N and square F back up.
+  constexpr int kPadeDegree = 6;
+  const int n = rows_;
+  const double norm = NormInf();
+  if (!std::isfinite(norm)) {
+    throw std::invalid_argument("ERROR: matrix has non-finite entries");
+  }
+  // A finite norm is below 2^1024, so the count stays far inside an int.
+  constexpr int kMaxSquarings = std::numeric_limits<double>::max_exponent + 1;
+  int squarings = 0;
+  if (norm > 0.5) {
+    squarings = std::clamp(
+        static_cast<int>(std::ceil(std::log2(norm))) + 1, 0, kMaxSquarings);
+  }
+
+  S21Matrix a(*this);
+  a.MulNumber(std::ldexp(1.0, -squarings));
+
+  S21Matrix x(a), numer(n, n), denom(n, n), scratch(n, n, uninitialized);
+  for (int i = 0; i < n; i++) {
+    numer.At(i, i) = 1.0;
+    denom.At(i, i) = 1.0;
+  }
+  double c = 0.5;
+  numer.Axpy(c, a);
+  denom.Axpy(-c, a);
+  for (int k = 2; k <= kPadeDegree; k++) {
+    c *= static_cast<double>(kPadeDegree - k + 1) /
+         (k * (2 * kPadeDegree - k + 1));
+    Gemm(1.0, a, x, 0.0, scratch);
+    std::swap(x, scratch);
+    numer.Axpy(c, x);
+    denom.Axpy(k % 2 == 0 ? c : -c, x);
+  }
+
+  std::vector<int> pivots(n);
+  const s21::Backend &backend = s21::CurrentBackend();
+  if (backend.LuFactor(n, denom.data(), n, pivots.data()) == 0.0) {
+    throw std::invalid_argument("ERROR: Pade denominator is singular");
+  }
+  backend.LuSolve(n, n, denom.matrix_, n, pivots.data(), numer.data(), n);
+  for (int i = 0; i < squarings; i++) {
+    Gemm(1.0, numer, numer, 0.0, scratch);
+    std::swap(numer, scratch);
+  }
+  return numer;
+}
+
+/* -------------- LINEAR SOLVERS AND MATRIX FUNCTIONS -------------- */
+
+/* -------------- ASYNC -------------- */
+
+s21::Task<S21Matrix> S21Matrix::MulMatrixAsync(const S21Matrix &other,
+                                               std::stop_token stop) const {
+  // Shared copies: the caller's next write detaches from the task's operands
+  // instead of the caller paying for a deep copy up front.
+  return s21::Async(
+      [lhs = S21Matrix(*this, true), rhs = S21Matrix(other, true)]() mutable {
+        lhs.MulMatrix(rhs);
+        return std::move(lhs);
+      },
+      std::move(stop));
+}
+
+s21::Task<double> S21Matrix::DeterminantAsync(std::stop_token stop) const {
+  return s21::Async(
+      [copy = S21Matrix(*this, true)] { return copy.Determinant(); },
+                    std::move(stop));
+}
+
+s21::Task<S21Matrix> S21Matrix::InverseMatrixAsync(
+    std::stop_token stop) const {
+  return s21::Async(
+      [copy = S21Matrix(*this, true)] { return copy.InverseMatrix(); },
+      std::move(stop));
+}
+
+/* -------------- ASYNC -------------- */
+
+/* -------------- REDUCTIONS -------------- */
+
+double S21Matrix::Sum() const {
+  const double *data = matrix_;
+  return reduceSum(static_cast<size_t>(rows_) * cols_,
+                   [data](size_t i) { return data[i]; });
+}
+
+double S21Matrix::Min() const {
+  if (matrix_ == nullptr) {
+    throw std::logic_error("Matrix is not initialized");
+  }
+  const double *data = matrix_;
+  std::vector<double> partials =
+      blockPartials(static_cast<size_t>(rows_) * cols_, kReduceBlock,
+                    [data](size_t first, size_t last) {
+                      return *std::min_element(data + first, data + last);
+                    });
+  return *std::min_element(partials.begin(), partials.end());
+}
+
+double S21Matrix::Max() const {
+  if (matrix_ == nullptr) {
+    throw std::logic_error("Matrix is not initialized");
+  }
+  const double *data = matrix_;
+  std::vector<double> partials =
+      blockPartials(static_cast<size_t>(rows_) * cols_, kReduceBlock,
+                    [data](size_t first, size_t last) {
+                      return *std::max_element(data + first, data + last);
+                    });
+  return *std::max_element(partials.begin(), partials.end());
+}
+
+double S21Matrix::NormFrobenius() const {
+  const double *data = matrix_;
+  return std::sqrt(reduceSum(static_cast<size_t>(rows_) * cols_,
+                             [data](size_t i) { return data[i] * data[i]; }));
+}
+
+double S21Matrix::Norm1() const {
+  if (matrix_ == nullptr) return 0.0;
+  const size_t cols = cols_;
+  const double *data = matrix_;
+  // Rows are cut into fixed blocks; each block keeps one compensated sum per
+  // column, and the blocks are then combined per column in block order.
+  const size_t block_rows = std::max<size_t>(1, kReduceBlock / cols);
+  const size_t blocks = (rows_ + block_rows - 1) / block_rows;
+  std::vector<double> partials(blocks * cols);
+  auto body = [&](size_t first, size_t last) {
+    std::vector<CompensatedSum> acc(cols);
+    for (size_t block = first; block < last; block++) {
+      std::fill(acc.begin(), acc.end(), CompensatedSum());
+      const size_t end = std::min<size_t>(rows_, (block + 1) * block_rows);
+      for (size_t i = block * block_rows; i < end; i++) {
+        const double *row = data + i * cols;
+        for (size_t j = 0; j < cols; j++) acc[j].Add(std::fabs(row[j]));
+      }
+      for (size_t j = 0; j < cols; j++) {
+        partials[block * cols + j] = acc[j].Value();
+      }
+    }
+  };
+  if (static_cast<size_t>(rows_) * cols < parallelThreshold()) {
+    body(0, blocks);
+  } else {
+    s21::ParallelFor(0, blocks, 1, body);
+  }
+  double norm = 0.0;
+  for (size_t j = 0; j < cols; j++) {
+    CompensatedSum column;
+    for (size_t block = 0; block < blocks; block++) {
+      column.Add(partials[block * cols + j]);
+    }
+    norm = std::max(norm, column.Value());
+  }
+  return norm;
+}
+
+double S21Matrix::NormInf() const {
+  if (matrix_ == nullptr) return 0.0;
+  const size_t cols = cols_;
+  const double *data = matrix_;
+  std::vector<double> sums(rows_);
+  auto body = [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      CompensatedSum acc;
+      const double *row = data + i * cols;
+      for (size_t j = 0; j < cols; j++) acc.Add(std::fabs(row[j]));
+      sums[i] = acc.Value();
+    }
+  };
+  if (static_cast<size_t>(rows_) * cols < parallelThreshold()) {
+    body(0, rows_);
+  } else {
+    s21::ParallelFor(0, rows_, std::max<size_t>(1, parallelGrain() / cols),
+                     body);
+  }
+  return *std::max_element(sums.begin(), sums.end());
+}
+
+double S21Matrix::Trace() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+  CompensatedSum acc;
   for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      if (std::fabs(matrix_[i][j] - other.matrix_[i][j]) >= 1e-7) return false;
+    acc.Add(matrix_[static_cast<size_t>(i) * cols_ + i]);
+  }
+  return acc.Value();
+}
+
+/* -------------- REDUCTIONS -------------- */
+
+/* -------------- CONTENT HASH -------------- */
+
+namespace {
+
+// Elements are hashed in fixed blocks of this many, so that large matrices
+// are hashed in parallel and the value never depends on the thread count.
+constexpr size_t kHashBlock = 1 << 16;
+// Keys of the eight accumulator lanes (the first fractional digits of pi).
+alignas(32) constexpr uint64_t kHashKeys[8] = {
+    0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL,
+    0x082EFA98EC4E6C89ULL, 0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+    0xC0AC29B7C97C50DDULL, 0x3F84D5B5B5470917ULL};
+
+// splitmix64 finalizer.
+uint64_t avalanche(uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBULL;
+  return h ^ (h >> 31);
+}
+
+// Stripes of eight words into eight lanes, as in the XXH3 accumulator: each
+// lane adds the product of the two 32-bit halves of its keyed word and the
+// word of its neighbouring lane.
+void hashStripesPortable(const double *data, size_t stripes, uint64_t *acc) {
+  for (size_t s = 0; s < stripes; s++) {
+    uint64_t words[8];
+    std::memcpy(words, data + s * 8, sizeof(words));
+    for (int lane = 0; lane < 8; lane++) {
+      const uint64_t x = words[lane] ^ kHashKeys[lane];
+      acc[lane] += (x & 0xFFFFFFFFULL) * (x >> 32) + words[lane ^ 1];
     }
   }
-  return true;
 }
 
-S21Matrix S21Matrix::InverseMatrix() {
-  S21Matrix copy(rows_, cols_);
-  copy.copyMatrix(*this);
-  double determ = copy.Determinant();
-  if (determ == 0) {
-    throw std::invalid_argument(
-        "ERROR: The determinant of this matrix is 0. The inverse matrix does "
-        "not exist.");
+#ifdef S21_HASH_X86
+
+// The same lanes, two vectors per stripe: mul_epu32 multiplies the low
+// halves of each 64-bit lane, and the shuffle swaps neighbouring lanes.
+__attribute__((target("avx2"))) void hashStripesAvx2(const double *data,
+                                                     size_t stripes,
+                                                     uint64_t *acc) {
+  __m256i *lanes = reinterpret_cast<__m256i *>(acc);
+  __m256i acc0 = _mm256_loadu_si256(lanes);
+  __m256i acc1 = _mm256_loadu_si256(lanes + 1);
+  const __m256i key0 =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(kHashKeys));
+  const __m256i key1 =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(kHashKeys + 4));
+  for (size_t s = 0; s < stripes; s++) {
+    const __m256i *words = reinterpret_cast<const __m256i *>(data + s * 8);
+    const __m256i w0 = _mm256_loadu_si256(words);
+    const __m256i w1 = _mm256_loadu_si256(words + 1);
+    const __m256i x0 = _mm256_xor_si256(w0, key0);
+    const __m256i x1 = _mm256_xor_si256(w1, key1);
+    acc0 = _mm256_add_epi64(
+        acc0, _mm256_add_epi64(
+                  _mm256_mul_epu32(x0, _mm256_srli_epi64(x0, 32)),
+                  _mm256_shuffle_epi32(w0, _MM_SHUFFLE(1, 0, 3, 2))));
+    acc1 = _mm256_add_epi64(
+        acc1, _mm256_add_epi64(
+                  _mm256_mul_epu32(x1, _mm256_srli_epi64(x1, 32)),
+                  _mm256_shuffle_epi32(w1, _MM_SHUFFLE(1, 0, 3, 2))));
   }
-  S21Matrix result(rows_, rows_);
-  S21Matrix temp = CalcComplements();
-  S21Matrix transpose_matrix = temp.Transpose();
-  result = transpose_matrix * (1.0 / determ);
-  return result;
+  _mm256_storeu_si256(lanes, acc0);
+  _mm256_storeu_si256(lanes + 1, acc1);
+}
+
+bool haveAvx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+
+#endif
+
+// Digest of one block: the lanes, then the words left over after the last
+// full stripe.
+uint64_t hashBlock(const double *data, size_t size) {
+  alignas(32) uint64_t acc[8];
+  std::copy(kHashKeys, kHashKeys + 8, acc);
+  const size_t stripes = size / 8;
+#ifdef S21_HASH_X86
+  if (haveAvx2()) {
+    hashStripesAvx2(data, stripes, acc);
+  } else {
+    hashStripesPortable(data, stripes, acc);
+  }
+#else
+  hashStripesPortable(data, stripes, acc);
+#endif
+  uint64_t h = size;
+  for (uint64_t lane : acc) h = avalanche(h ^ lane);
+  for (size_t i = stripes * 8; i < size; i++) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    h = avalanche(h ^ word);
+  }
+  return h;
+}
+
+}  // namespace
+
+uint64_t S21Matrix::Hash() const {
+  uint64_t h = hash_.load(std::memory_order_relaxed);
+  if (h != 0) return h;
+
+  const size_t size = static_cast<size_t>(rows_) * cols_;
+  const size_t blocks = (size + kHashBlock - 1) / kHashBlock;
+  std::vector<uint64_t> digests(blocks);
+  auto body = [this, size, &digests](size_t first, size_t last) {
+    for (size_t b = first; b < last; b++) {
+      const size_t begin = b * kHashBlock;
+      digests[b] = hashBlock(matrix_ + begin,
+                             std::min(kHashBlock, size - begin));
+    }
+  };
+  if (blocks <= 1) {
+    body(0, blocks);
+  } else {
+    s21::ParallelFor(0, blocks, 1, body);
+  }
+  h = avalanche((static_cast<uint64_t>(rows_) << 32) ^
+                static_cast<uint32_t>(cols_));
+  for (uint64_t digest : digests) h = avalanche(h ^ digest);
+  // 0 marks a hash that has not been computed yet.
+  if (h == 0) h = 1;
+  clearWritable();
+  hash_.store(h, std::memory_order_relaxed);
+  return h;
 }
 
-/* -------------- FUNCTIONS -------------- */
\ No newline at end of file
+/* -------------- CONTENT HASH -------------- */
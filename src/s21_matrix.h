@@ -1,23 +1,110 @@
 #ifndef S21_MATRIX_H
 #define S21_MATRIX_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+
+#include "s21_async.h"
 
 class S21Matrix {
+ public:
+  // Matrices with up to this many elements keep them inside the object
+  // instead of on the heap. Such matrices are never shared in copy-on-write
+  // mode, and pointers to their elements do not survive a move.
+  static constexpr int kInlineCapacity = 16;
+
  private:
+  // Reference-counted element block, followed in memory by the elements. In
+  // copy-on-write mode copies share one block and the first mutating call
+  // gives the writer a private copy.
+  struct alignas(std::max_align_t) Buffer {
+    std::atomic<int> refs;
+    bool huge;  // allocated huge-page aligned, released with std::free
+    double* data() noexcept { return reinterpret_cast<double*>(this + 1); }
+  };
+
   int rows_, cols_;
-  double** matrix_;
-  void initMatrix();
+  // rows_ * cols_ elements, row-major: inside buffer_, or in inline_ with
+  // buffer_ == nullptr when there are at most kInlineCapacity of them.
+  double* matrix_;
+  Buffer* buffer_;
+  // Content hash, 0 until Hash() computes it; reset by every writer.
+  mutable std::atomic<uint64_t> hash_{0};
+  // Set once no hash is cached and the storage is private, so writers skip
+  // both checks. Cleared by Hash() and by copies, through std::atomic_ref as
+  // those run on const matrices; read plainly, and so hoistable out of loops,
+  // by the non-const members, which never run concurrently with them.
+  mutable bool writable_ = false;
+  alignas(32) double inline_[kInlineCapacity];
+  void initMatrix(bool zero_fill = true);
   void copyMatrix(const S21Matrix& other);
   void clearMatrix();
+  void freeMatrix() noexcept;
+  void reshape(int rows, int cols);
+  void detach(bool keep_contents);
+  void adoptBuffer(Buffer* buffer) noexcept;
+  void useInline() noexcept;
+  void takeStorage(S21Matrix& other) noexcept;
+  static Buffer* allocateBuffer(size_t size);
+  static void releaseBuffer(Buffer* buffer) noexcept;
+  // Runs body over [0, count) in chunks, on the pool once count * cost
+  // (elements touched) is large enough.
+  static void forChunks(size_t count, size_t cost,
+                        const std::function<void(size_t, size_t)>& body);
+  void checkSameSize(const S21Matrix& other) const;
+  // A copy that shares the heap storage of `other` when `share` is set,
+  // whatever the copy-on-write mode; writers then detach as in that mode.
+  S21Matrix(const S21Matrix& other, bool share);
+  // A matrix of the same shape with unset elements; empty for an empty one.
+  S21Matrix sameShape() const;
+  void makeWritable();
+  void clearWritable() const noexcept {
+    std::atomic_ref<bool>(writable_).store(false, std::memory_order_relaxed);
+  }
+  // Called by every mutating member before it writes to the elements.
+  void prepareWrite() {
+    if (!writable_) [[unlikely]] makeWritable();
+  }
 
  public:
   S21Matrix() noexcept;
   S21Matrix(int rows, int cols);
+  // Tag for constructing a matrix whose elements are left unset, for callers
+  // that overwrite every element straight away.
+  struct uninitialized_t {
+    explicit uninitialized_t() = default;
+  };
+  static constexpr uninitialized_t uninitialized{};
+  S21Matrix(int rows, int cols, uninitialized_t);
   S21Matrix(const S21Matrix& other);
   S21Matrix(S21Matrix&& other) noexcept;
   ~S21Matrix() noexcept;
 
+  // Copy-on-write mode, off by default. While it is on, copies share their
+  // elements until one side is modified, and the reference count is atomic
+  // so shared matrices may be read from several threads at once. References
+  // and pointers obtained from non-const accessors are invalidated when the
+  // matrix is copied.
+  static void SetCopyOnWrite(bool enabled) noexcept;
+  static bool CopyOnWrite() noexcept;
+  bool IsShared() const noexcept;
+
+  // Buffers of at least 2 MiB are allocated 2 MiB-aligned and advised for
+  // transparent huge pages while this is on; off by default.
+  static void SetHugePages(bool enabled) noexcept;
+  static bool HugePages() noexcept;
+
+  // 64-bit hash of the shape and the bit patterns of the elements, computed
+  // on first use and kept until the matrix is modified. Writes through a
+  // reference or pointer obtained before the last call are not noticed.
+  uint64_t Hash() const;
+
   int GetRows() const noexcept;
   int GetCols() const noexcept;
   void SetRows(int new_rows);
@@ -27,11 +114,18 @@ class S21Matrix {
   void SubMatrix(const S21Matrix& other);
   void MulNumber(const double num);
   void MulMatrix(const S21Matrix& other);
-  S21Matrix Transpose();
-  double Determinant();
-  S21Matrix CalcComplements();
-  S21Matrix InverseMatrix();
-  bool EqMatrix(const S21Matrix& other);
+  S21Matrix Transpose() const;
+  // Determinant, CalcComplements and InverseMatrix consult s21::ResultCache
+  // when it is enabled.
+  double Determinant() const;
+  // Cofactor matrix, O(n^3) via a complete-pivoting LU; also exact for
+  // singular matrices.
+  S21Matrix CalcComplements() const;
+  // Transposed cofactor matrix, adj(A) = det(A) * inv(A) when invertible.
+  S21Matrix Adjugate() const;
+  // Solves this * X = I with one LU factorization.
+  S21Matrix InverseMatrix() const;
+  bool EqMatrix(const S21Matrix& other) const;
 
   void PrintMatrix() const;
 
@@ -39,13 +133,206 @@ class S21Matrix {
   S21Matrix operator-(const S21Matrix& other);
   S21Matrix operator*(const S21Matrix& other);
   S21Matrix operator*(const double num);
-  bool operator==(const S21Matrix& other);
+  bool operator==(const S21Matrix& other) const;
   S21Matrix& operator=(const S21Matrix& other);
+  S21Matrix& operator=(S21Matrix&& other) noexcept;
   S21Matrix& operator+=(const S21Matrix& other);
   S21Matrix& operator-=(const S21Matrix& other);
   S21Matrix& operator*=(const S21Matrix& other);
   S21Matrix& operator*=(const double num);
   double& operator()(int i, int j);
+  const double& operator()(int i, int j) const;
+
+  // Unchecked access for hot loops: the caller guarantees 0 <= i < rows and
+  // 0 <= j < cols. Storage is one row-major block of rows * cols doubles.
+  double& At(int i, int j) {
+    prepareWrite();
+    return matrix_[static_cast<size_t>(i) * cols_ + j];
+  }
+  const double& At(int i, int j) const noexcept {
+    return matrix_[static_cast<size_t>(i) * cols_ + j];
+  }
+  double* data() {
+    prepareWrite();
+    return matrix_;
+  }
+  const double* data() const noexcept { return matrix_; }
+  size_t size() const noexcept { return static_cast<size_t>(rows_) * cols_; }
+
+  // Bounds-checked view of one row.
+  std::span<double> Row(int i);
+  std::span<const double> Row(int i) const;
+
+  // Contiguous random-access iterators over all elements in row-major order,
+  // usable with <algorithm> and the parallel STL.
+  using iterator = double*;
+  using const_iterator = const double*;
+  iterator begin() { return data(); }
+  iterator end() { return data() + size(); }
+  const_iterator begin() const noexcept { return matrix_; }
+  const_iterator end() const noexcept { return matrix_ + size(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // BLAS-style fused operations. The output is written in place and is only
+  // reallocated when it does not already have the required shape.
+
+  // c = alpha * op(a) * op(b) + beta * c, op(x) = x or x^T per trans flag.
+  // Products, transposes and LU factorizations run on s21::CurrentBackend().
+  static void Gemm(double alpha, const S21Matrix& a, const S21Matrix& b,
+                   double beta, S21Matrix& c, bool trans_a = false,
+                   bool trans_b = false);
+  // c = alpha * op(a) * op(a)^T + beta * c, op(a) = a or a^T per trans: the
+  // symmetric rank-k update. Only the lower triangle is computed, for half
+  // the work of the equivalent Gemm, and then mirrored; with beta != 0 only
+  // the lower triangle of c is read.
+  static void Syrk(double alpha, const S21Matrix& a, double beta,
+                   S21Matrix& c, bool trans = false);
+  // Gram matrix of the columns, A^T A, or with trans == false of the rows,
+  // A A^T, by Syrk and without forming the transpose.
+  S21Matrix Gram(bool trans = true) const;
+  // this = this + alpha * x
+  void Axpy(double alpha, const S21Matrix& x);
+  // this = scale * this + alpha * x
+  void ScaleAdd(double scale, double alpha, const S21Matrix& x);
+
+  // Element-wise engine. f and g are called concurrently on large matrices
+  // and must be safe to call from several threads; being templates, they
+  // are inlined into the element loop.
+  //   Apply:   result(i, j) = f(this(i, j))
+  //   ZipWith: result(i, j) = g(this(i, j), other(i, j))
+  template <typename F>
+  S21Matrix Apply(F f) const;
+  template <typename F>
+  void ApplyInPlace(F f);
+  template <typename G>
+  S21Matrix ZipWith(G g, const S21Matrix& other) const;
+  template <typename G>
+  void ZipWithInPlace(G g, const S21Matrix& other);
+  // Broadcasting, in place: this(i, j) = g(this(i, j), row(0, j)) for a
+  // 1 x cols `row`, and g(this(i, j), column(i, 0)) for a rows x 1 `column`.
+  template <typename G>
+  void ZipWithRow(G g, const S21Matrix& row);
+  template <typename G>
+  void ZipWithColumn(G g, const S21Matrix& column);
+
+  // Hadamard (element-wise) product and quotient.
+  void HadamardMul(const S21Matrix& other);
+  void HadamardDiv(const S21Matrix& other);
+  S21Matrix HadamardProduct(const S21Matrix& other) const;
+  S21Matrix HadamardQuotient(const S21Matrix& other) const;
+  // Adds to or scales every row by `row`, or every column by `column`.
+  void AddRow(const S21Matrix& row);
+  void MulRow(const S21Matrix& row);
+  void AddColumn(const S21Matrix& column);
+  void MulColumn(const S21Matrix& column);
+
+  // Solves this * X = b for X by LU factorization with partial pivoting.
+  S21Matrix Solve(const S21Matrix& b) const;
+  // this^k by square-and-multiply; negative k raises the inverse.
+  S21Matrix Pow(int k) const;
+  // Matrix exponential, Pade approximation with scaling and squaring.
+  S21Matrix Exp() const;
+
+  // Asynchronous variants for long-running operations. They run on the
+  // library's thread pool and stop at the next cancellation point once
+  // `stop` is triggered. The task shares the operands' storage, as copies do
+  // in copy-on-write mode: the operands may be modified or destroyed right
+  // after the call, but not through references or pointers obtained from
+  // their non-const accessors before it.
+  s21::Task<S21Matrix> MulMatrixAsync(const S21Matrix& other,
+                                      std::stop_token stop = {}) const;
+  s21::Task<double> DeterminantAsync(std::stop_token stop = {}) const;
+  s21::Task<S21Matrix> InverseMatrixAsync(std::stop_token stop = {}) const;
+
+  // Reductions. Large matrices are reduced on several threads; sums use
+  // compensated block sums combined pairwise, so results are reproducible
+  // regardless of the thread count.
+  double Sum() const;
+  double Min() const;
+  double Max() const;
+  double NormFrobenius() const;
+  double Norm1() const;    // maximum absolute column sum
+  double NormInf() const;  // maximum absolute row sum
+  double Trace() const;
 };
 
-#endif
\ No newline at end of file
+template <typename F>
+S21Matrix S21Matrix::Apply(F f) const {
+  S21Matrix result = sameShape();
+  const double* src = matrix_;
+  double* dst = result.matrix_;
+  forChunks(size(), 1, [src, dst, &f](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) dst[i] = f(src[i]);
+  });
+  return result;
+}
+
+template <typename F>
+void S21Matrix::ApplyInPlace(F f) {
+  prepareWrite();
+  double* data = matrix_;
+  forChunks(size(), 1, [data, &f](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) data[i] = f(data[i]);
+  });
+}
+
+template <typename G>
+S21Matrix S21Matrix::ZipWith(G g, const S21Matrix& other) const {
+  checkSameSize(other);
+  S21Matrix result = sameShape();
+  const double *lhs = matrix_, *rhs = other.matrix_;
+  double* dst = result.matrix_;
+  forChunks(size(), 1, [lhs, rhs, dst, &g](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) dst[i] = g(lhs[i], rhs[i]);
+  });
+  return result;
+}
+
+template <typename G>
+void S21Matrix::ZipWithInPlace(G g, const S21Matrix& other) {
+  checkSameSize(other);
+  prepareWrite();
+  double* data = matrix_;
+  const double* src = other.matrix_;
+  forChunks(size(), 1, [data, src, &g](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) data[i] = g(data[i], src[i]);
+  });
+}
+
+template <typename G>
+void S21Matrix::ZipWithRow(G g, const S21Matrix& row) {
+  if (matrix_ == nullptr || row.rows_ != 1 || row.cols_ != cols_) {
+    throw std::invalid_argument("ERROR: row must be 1 x cols");
+  }
+  prepareWrite();
+  double* data = matrix_;
+  const double* src = row.matrix_;
+  const size_t cols = cols_;
+  forChunks(rows_, cols, [data, src, cols, &g](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      double* out = data + i * cols;
+      for (size_t j = 0; j < cols; j++) out[j] = g(out[j], src[j]);
+    }
+  });
+}
+
+template <typename G>
+void S21Matrix::ZipWithColumn(G g, const S21Matrix& column) {
+  if (matrix_ == nullptr || column.cols_ != 1 || column.rows_ != rows_) {
+    throw std::invalid_argument("ERROR: column must be rows x 1");
+  }
+  prepareWrite();
+  double* data = matrix_;
+  const double* src = column.matrix_;
+  const size_t cols = cols_;
+  forChunks(rows_, cols, [data, src, cols, &g](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      double* out = data + i * cols;
+      const double y = src[i];
+      for (size_t j = 0; j < cols; j++) out[j] = g(out[j], y);
+    }
+  });
+}
+
+#endif
@@ -0,0 +1,565 @@
+#include "s21_matrix_io.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "s21_parallel.h"
+
+namespace s21 {
+
+namespace {
+
+// A filled read buffer is cut into segments of about this many bytes, the
+// unit of parallel parsing.
+constexpr size_t kSegmentBytes = size_t{1} << 18;
+// Numbers formatted per output slice, the unit of parallel formatting.
+constexpr size_t kSliceNumbers = size_t{1} << 14;
+
+[[noreturn]] void malformed(const std::string &what) {
+  throw std::invalid_argument("ERROR: malformed input: " + what);
+}
+
+bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char *skipBlanks(const char *p, const char *end) {
+  while (p != end && isBlank(*p)) p++;
+  return p;
+}
+
+// Parses the number at p, after optional blanks, and moves p past it.
+double parseNumber(const char *&p, const char *end) {
+  p = skipBlanks(p, end);
+  // from_chars takes no '+', so skip one, but not a second sign after it.
+  if (p != end && *p == '+') {
+    p++;
+    if (p != end && (*p == '+' || *p == '-')) malformed("expected a number");
+  }
+  double value = 0.0;
+  const auto [next, ec] = std::from_chars(p, end, value);
+  if (ec != std::errc()) malformed("expected a number");
+  p = next;
+  return value;
+}
+
+long parseIndex(const char *&p, const char *end) {
+  p = skipBlanks(p, end);
+  long value = 0;
+  const auto [next, ec] = std::from_chars(p, end, value);
+  if (ec != std::errc()) malformed("expected an integer");
+  p = next;
+  return value;
+}
+
+// Calls on_line(first, last) for every line of `text`, newline excluded.
+template <typename F>
+void forEachLine(std::string_view text, const F &on_line) {
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while (p != end) {
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    on_line(p, eol != nullptr ? eol : end);
+    p = eol != nullptr ? eol + 1 : end;
+  }
+}
+
+// Streams `in` through a buffer of buffer_size bytes and calls
+// on_block(text) with the longest prefix of the buffer made of whole lines;
+// the partial line at the end is carried over to the next read. A line
+// longer than the buffer grows it.
+template <typename F>
+void forEachBlock(std::istream &in, size_t buffer_size, const F &on_block) {
+  std::vector<char> buffer(std::max<size_t>(buffer_size, 64));
+  size_t carry = 0;
+  for (;;) {
+    if (carry == buffer.size()) buffer.resize(buffer.size() * 2);
+    in.read(buffer.data() + carry, buffer.size() - carry);
+    if (in.bad()) throw std::runtime_error("ERROR: read failed");
+    const size_t filled = carry + static_cast<size_t>(in.gcount());
+    const bool last = in.eof();
+    size_t end = filled;
+    if (!last) {
+      while (end > 0 && buffer[end - 1] != '\n') end--;
+      if (end == 0) {
+        carry = filled;
+        continue;
+      }
+    }
+    if (end > 0) on_block(std::string_view(buffer.data(), end));
+    if (last) return;
+    carry = filled - end;
+    std::memmove(buffer.data(), buffer.data() + end, carry);
+  }
+}
+
+// Cuts `block` at line boundaries into segments of about kSegmentBytes and
+// runs parse(segment, result) for each on the pool. results[i] belongs to
+// the i-th segment; the vector is reused from block to block, so parse must
+// reset its result first.
+template <typename Result, typename F>
+void parseSegments(std::string_view block, std::vector<Result> &results,
+                   const F &parse) {
+  std::vector<std::string_view> segments;
+  for (size_t pos = 0; pos < block.size();) {
+    size_t cut = std::min(block.size(), pos + kSegmentBytes);
+    if (cut < block.size()) {
+      const size_t eol = block.find('\n', cut);
+      cut = eol == std::string_view::npos ? block.size() : eol + 1;
+    }
+    segments.push_back(block.substr(pos, cut - pos));
+    pos = cut;
+  }
+  if (results.size() < segments.size()) results.resize(segments.size());
+  ParallelFor(0, segments.size(), 1, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) parse(segments[i], results[i]);
+  });
+}
+
+int checkedDimension(long value) {
+  if (value <= 0 || value > INT_MAX) malformed("invalid matrix dimension");
+  return static_cast<int>(value);
+}
+
+std::ifstream openInput(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("ERROR: cannot open " + path);
+  return in;
+}
+
+// The readers reject an empty matrix, so the writers refuse to produce one.
+void checkInitialized(const S21Matrix &matrix) {
+  if (matrix.GetRows() <= 0 || matrix.GetCols() <= 0) {
+    throw std::invalid_argument("ERROR: Matrix is not initialized");
+  }
+}
+
+std::ofstream openOutput(const std::string &path) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) throw std::runtime_error("ERROR: cannot open " + path);
+  return out;
+}
+
+void appendNumber(std::string &text, double value) {
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  text.append(buffer, result.ptr);
+}
+
+void appendIndex(std::string &text, long value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  text.append(buffer, result.ptr);
+}
+
+// Formats lines [0, count), each about `numbers` numbers long, with
+// format(line, text). Batches of slices are formatted on the pool and
+// written to `out` in order, so memory stays bounded by one batch.
+template <typename F>
+void writeLines(std::ostream &out, size_t count, size_t numbers,
+                const F &format) {
+  const size_t per_slice =
+      std::max<size_t>(1, kSliceNumbers / std::max<size_t>(1, numbers));
+  std::vector<std::string> slices(4 * ThreadPool::Instance().Concurrency());
+  const size_t batch = per_slice * slices.size();
+  for (size_t first = 0; first < count; first += batch) {
+    const size_t last = std::min(count, first + batch);
+    const size_t used = (last - first + per_slice - 1) / per_slice;
+    ParallelFor(0, used, 1, [&](size_t lo, size_t hi) {
+      for (size_t s = lo; s < hi; s++) {
+        std::string &text = slices[s];
+        text.clear();
+        const size_t begin = first + s * per_slice;
+        const size_t end = std::min(last, begin + per_slice);
+        for (size_t line = begin; line < end; line++) format(line, text);
+      }
+    });
+    for (size_t s = 0; s < used; s++) {
+      out.write(slices[s].data(), slices[s].size());
+    }
+  }
+  out.flush();
+  if (!out) throw std::runtime_error("ERROR: write failed");
+}
+
+// Appends the fields of one CSV line to `values` and returns their number,
+// 0 for a blank line.
+size_t parseCsvLine(const char *p, const char *end, char delimiter,
+                    std::vector<double> &values) {
+  if (skipBlanks(p, end) == end) return 0;
+  size_t fields = 0;
+  for (;;) {
+    values.push_back(parseNumber(p, end));
+    fields++;
+    const char *next = skipBlanks(p, end);
+    if (next == end) return fields;
+    if (isBlank(delimiter)) {
+      if (next == p) malformed("unexpected character in CSV");
+      p = next;
+    } else {
+      if (*next != delimiter) malformed("unexpected character in CSV");
+      p = next + 1;
+    }
+  }
+}
+
+struct CsvSegment {
+  std::vector<double> values;
+  size_t cols = 0;  // 0 when the segment holds no rows
+};
+
+// The number of non-blank lines left in `in`, which is then rewound to
+// where it was; 0 when the stream cannot be rewound.
+size_t countCsvRows(std::istream &in, size_t buffer_size) {
+  const std::streampos start = in.tellg();
+  if (start == std::streampos(-1)) return 0;
+  size_t rows = 0;
+  forEachBlock(in, buffer_size, [&rows](std::string_view block) {
+    forEachLine(block, [&rows](const char *p, const char *end) {
+      if (skipBlanks(p, end) != end) rows++;
+    });
+  });
+  in.clear();
+  if (!in.seekg(start)) throw std::runtime_error("ERROR: read failed");
+  return rows;
+}
+
+// Copies `count` rows of `cols` values to row `row` of `matrix`, growing it
+// when it is too short; its rows past the ones written are unset.
+void appendRows(S21Matrix &matrix, size_t row, size_t cols,
+                const double *values, size_t count) {
+  const size_t capacity = matrix.GetRows();
+  if (row + count > capacity) {
+    const size_t grown = std::max(row + count, capacity + capacity / 2);
+    if (grown > INT_MAX || cols > INT_MAX) {
+      malformed("invalid matrix dimension");
+    }
+    S21Matrix larger(static_cast<int>(grown), static_cast<int>(cols),
+                     S21Matrix::uninitialized);
+    if (row > 0) std::copy_n(matrix.data(), row * cols, larger.data());
+    matrix = std::move(larger);
+  }
+  std::copy_n(values, count * cols, matrix.data() + row * cols);
+}
+
+enum class Symmetry { kGeneral, kSymmetric, kSkew };
+
+struct MarketHeader {
+  bool coordinate = false;
+  bool pattern = false;
+  Symmetry symmetry = Symmetry::kGeneral;
+  int rows = 0, cols = 0;
+  long entries = 0;
+};
+
+MarketHeader readMarketHeader(std::istream &in) {
+  std::string line;
+  if (!std::getline(in, line)) malformed("empty input");
+  std::transform(line.begin(), line.end(), line.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  std::istringstream words(line);
+  std::string banner, object, format, field, symmetry;
+  words >> banner >> object >> format >> field >> symmetry;
+  if (banner != "%%matrixmarket" || object != "matrix") {
+    malformed("missing %%MatrixMarket matrix banner");
+  }
+
+  MarketHeader header;
+  if (format == "coordinate") {
+    header.coordinate = true;
+  } else if (format != "array") {
+    malformed("unknown format " + format);
+  }
+  if (field == "pattern" && header.coordinate) {
+    header.pattern = true;
+  } else if (field != "real" && field != "double" && field != "integer") {
+    throw std::invalid_argument("ERROR: unsupported Matrix Market field " +
+                                field);
+  }
+  if (symmetry == "symmetric") {
+    header.symmetry = Symmetry::kSymmetric;
+  } else if (symmetry == "skew-symmetric") {
+    header.symmetry = Symmetry::kSkew;
+  } else if (symmetry != "general") {
+    throw std::invalid_argument("ERROR: unsupported Matrix Market symmetry " +
+                                symmetry);
+  }
+
+  do {
+    if (!std::getline(in, line)) malformed("missing size line");
+  } while (skipBlanks(line.data(), line.data() + line.size()) ==
+               line.data() + line.size() ||
+           line[0] == '%');
+  const char *p = line.data();
+  const char *end = p + line.size();
+  header.rows = checkedDimension(parseIndex(p, end));
+  header.cols = checkedDimension(parseIndex(p, end));
+  if (header.coordinate) {
+    header.entries = parseIndex(p, end);
+    if (header.entries < 0) malformed("negative entry count");
+  }
+  if (skipBlanks(p, end) != end) malformed("trailing characters");
+  if (header.symmetry != Symmetry::kGeneral && header.rows != header.cols) {
+    malformed("symmetric matrix must be square");
+  }
+  return header;
+}
+
+bool isCommentOrBlank(const char *p, const char *end) {
+  p = skipBlanks(p, end);
+  return p == end || *p == '%';
+}
+
+// Array entries run down the columns; symmetric storage keeps the lower
+// triangle, skew-symmetric the strict lower triangle.
+S21Matrix readMarketArray(std::istream &in, const MarketHeader &header,
+                          size_t buffer_size) {
+  const long rows = header.rows, cols = header.cols;
+  S21Matrix matrix(header.rows, header.cols);
+  double *a = matrix.data();
+  auto first_row = [&header](long j) {
+    if (header.symmetry == Symmetry::kSymmetric) return j;
+    if (header.symmetry == Symmetry::kSkew) return j + 1;
+    return 0L;
+  };
+  long i = first_row(0), j = 0;
+  auto normalize = [&] {
+    while (j < cols && i >= rows) i = first_row(++j);
+  };
+  normalize();
+
+  std::vector<std::vector<double>> parts;
+  forEachBlock(in, buffer_size, [&](std::string_view block) {
+    parseSegments(block, parts,
+                  [](std::string_view segment, std::vector<double> &values) {
+                    values.clear();
+                    forEachLine(segment, [&](const char *p, const char *end) {
+                      if (isCommentOrBlank(p, end)) return;
+                      while (skipBlanks(p, end) != end) {
+                        values.push_back(parseNumber(p, end));
+                      }
+                    });
+                  });
+    for (const std::vector<double> &values : parts) {
+      for (double value : values) {
+        if (j >= cols) malformed("too many entries");
+        a[i * cols + j] = value;
+        if (header.symmetry == Symmetry::kSymmetric) {
+          a[j * cols + i] = value;
+        } else if (header.symmetry == Symmetry::kSkew) {
+          a[j * cols + i] = -value;
+        }
+        i++;
+        normalize();
+      }
+    }
+    for (std::vector<double> &values : parts) values.clear();
+  });
+  if (j < cols) malformed("too few entries");
+  return matrix;
+}
+
+struct MarketEntry {
+  long i, j;
+  double value;
+};
+
+S21Matrix readMarketCoordinate(std::istream &in, const MarketHeader &header,
+                               size_t buffer_size) {
+  const long rows = header.rows, cols = header.cols;
+  S21Matrix matrix(header.rows, header.cols);
+  double *a = matrix.data();
+  long seen = 0;
+
+  std::vector<std::vector<MarketEntry>> parts;
+  forEachBlock(in, buffer_size, [&](std::string_view block) {
+    parseSegments(
+        block, parts,
+        [&header, rows, cols](std::string_view segment,
+                              std::vector<MarketEntry> &entries) {
+          entries.clear();
+          forEachLine(segment, [&](const char *p, const char *end) {
+            if (isCommentOrBlank(p, end)) return;
+            MarketEntry entry;
+            entry.i = parseIndex(p, end) - 1;
+            entry.j = parseIndex(p, end) - 1;
+            entry.value = header.pattern ? 1.0 : parseNumber(p, end);
+            if (skipBlanks(p, end) != end) malformed("trailing characters");
+            if (entry.i < 0 || entry.i >= rows || entry.j < 0 ||
+                entry.j >= cols) {
+              malformed("entry index out of range");
+            }
+            // Its diagonal is zero by definition, and (i, i) = -v would
+            // overwrite the value just stored.
+            if (header.symmetry == Symmetry::kSkew && entry.i == entry.j) {
+              malformed("diagonal entry in skew-symmetric matrix");
+            }
+            entries.push_back(entry);
+          });
+        });
+    for (std::vector<MarketEntry> &entries : parts) {
+      seen += static_cast<long>(entries.size());
+      if (seen > header.entries) malformed("too many entries");
+      for (const MarketEntry &e : entries) {
+        a[e.i * cols + e.j] = e.value;
+        if (header.symmetry == Symmetry::kSymmetric) {
+          a[e.j * cols + e.i] = e.value;
+        } else if (header.symmetry == Symmetry::kSkew) {
+          a[e.j * cols + e.i] = -e.value;
+        }
+      }
+      entries.clear();
+    }
+  });
+  if (seen != header.entries) malformed("too few entries");
+  return matrix;
+}
+
+}  // namespace
+
+/* -------------- CSV -------------- */
+
+S21Matrix ReadCsv(std::istream &in, char delimiter, size_t buffer_size) {
+  if (delimiter == '\n' || delimiter == '.' || delimiter == '-' ||
+      std::isdigit(static_cast<unsigned char>(delimiter))) {
+    throw std::invalid_argument("ERROR: invalid CSV delimiter");
+  }
+  // Values go straight into the result. A seekable stream is counted
+  // first, so the result is allocated once at its final size; otherwise it
+  // grows by half as rows arrive and is trimmed at the end.
+  const size_t expected = countCsvRows(in, buffer_size);
+  S21Matrix matrix;
+  size_t rows = 0, cols = 0;
+  std::vector<CsvSegment> parts;
+  forEachBlock(in, buffer_size, [&](std::string_view block) {
+    parseSegments(block, parts,
+                  [delimiter](std::string_view segment, CsvSegment &part) {
+                    part.values.clear();
+                    part.cols = 0;
+                    forEachLine(segment, [&](const char *p, const char *end) {
+                      const size_t fields =
+                          parseCsvLine(p, end, delimiter, part.values);
+                      if (fields == 0) return;
+                      if (part.cols == 0) part.cols = fields;
+                      if (fields != part.cols) malformed("ragged CSV rows");
+                    });
+                  });
+    for (CsvSegment &part : parts) {
+      if (part.cols == 0) continue;
+      const size_t count = part.values.size() / part.cols;
+      if (cols == 0) {
+        cols = part.cols;
+        const size_t capacity = std::max(expected, count);
+        if (capacity > INT_MAX || cols > INT_MAX) {
+          malformed("invalid matrix dimension");
+        }
+        matrix = S21Matrix(static_cast<int>(capacity), static_cast<int>(cols),
+                           S21Matrix::uninitialized);
+      }
+      if (part.cols != cols) malformed("ragged CSV rows");
+      appendRows(matrix, rows, cols, part.values.data(), count);
+      rows += count;
+      part.values.clear();
+      part.cols = 0;
+    }
+  });
+  if (rows == 0) malformed("no data");
+  if (rows != static_cast<size_t>(matrix.GetRows())) {
+    matrix.SetRows(static_cast<int>(rows));
+  }
+  return matrix;
+}
+
+S21Matrix ReadCsv(const std::string &path, char delimiter) {
+  std::ifstream in = openInput(path);
+  return ReadCsv(in, delimiter);
+}
+
+void WriteCsv(const S21Matrix &matrix, std::ostream &out, char delimiter) {
+  checkInitialized(matrix);
+  const size_t cols = matrix.GetCols();
+  const double *a = matrix.data();
+  writeLines(out, matrix.GetRows(), cols,
+             [a, cols, delimiter](size_t i, std::string &text) {
+               const double *row = a + i * cols;
+               for (size_t j = 0; j < cols; j++) {
+                 if (j != 0) text.push_back(delimiter);
+                 appendNumber(text, row[j]);
+               }
+               text.push_back('\n');
+             });
+}
+
+void WriteCsv(const S21Matrix &matrix, const std::string &path,
+              char delimiter) {
+  checkInitialized(matrix);
+  std::ofstream out = openOutput(path);
+  WriteCsv(matrix, out, delimiter);
+}
+
+/* -------------- MATRIX MARKET -------------- */
+
+S21Matrix ReadMatrixMarket(std::istream &in, size_t buffer_size) {
+  const MarketHeader header = readMarketHeader(in);
+  return header.coordinate ? readMarketCoordinate(in, header, buffer_size)
+                           : readMarketArray(in, header, buffer_size);
+}
+
+S21Matrix ReadMatrixMarket(const std::string &path) {
+  std::ifstream in = openInput(path);
+  return ReadMatrixMarket(in);
+}
+
+void WriteMatrixMarket(const S21Matrix &matrix, std::ostream &out,
+                       MatrixMarketFormat format) {
+  checkInitialized(matrix);
+  const size_t rows = matrix.GetRows(), cols = matrix.GetCols();
+  const double *a = matrix.data();
+  if (format == MatrixMarketFormat::kArray) {
+    out << "%%MatrixMarket matrix array real general\n"
+        << rows << ' ' << cols << '\n';
+    // One column per formatted line group, as the format is column-major.
+    writeLines(out, cols, rows, [a, rows, cols](size_t j, std::string &text) {
+      for (size_t i = 0; i < rows; i++) {
+        appendNumber(text, a[i * cols + j]);
+        text.push_back('\n');
+      }
+    });
+  } else {
+    const size_t nonzeros =
+        std::count_if(matrix.cbegin(), matrix.cend(),
+                      [](double value) { return value != 0.0; });
+    out << "%%MatrixMarket matrix coordinate real general\n"
+        << rows << ' ' << cols << ' ' << nonzeros << '\n';
+    writeLines(out, rows, cols, [a, cols](size_t i, std::string &text) {
+      const double *row = a + i * cols;
+      for (size_t j = 0; j < cols; j++) {
+        if (row[j] == 0.0) continue;
+        appendIndex(text, static_cast<long>(i) + 1);
+        text.push_back(' ');
+        appendIndex(text, static_cast<long>(j) + 1);
+        text.push_back(' ');
+        appendNumber(text, row[j]);
+        text.push_back('\n');
+      }
+    });
+  }
+}
+
+void WriteMatrixMarket(const S21Matrix &matrix, const std::string &path,
+                       MatrixMarketFormat format) {
+  checkInitialized(matrix);
+  std::ofstream out = openOutput(path);
+  WriteMatrixMarket(matrix, out, format);
+}
+
+}  // namespace s21
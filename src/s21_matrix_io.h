@@ -0,0 +1,51 @@
+#ifndef S21_MATRIX_IO_H
+#define S21_MATRIX_IO_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "s21_matrix.h"
+
+// Text import and export in CSV and Matrix Market format.
+//
+// Readers pull the input through a fixed-size buffer, so files of any size
+// are streamed rather than loaded whole. Every filled buffer is cut at line
+// boundaries into segments that are parsed on the thread pool; numbers go
+// through std::from_chars and std::to_chars, which round-trip exactly.
+// Malformed input throws std::invalid_argument, I/O failures
+// std::runtime_error. Neither format can hold an empty matrix: the writers
+// throw std::invalid_argument for one.
+namespace s21 {
+
+inline constexpr size_t kIoBufferSize = size_t{1} << 23;
+
+// One row per line, `delimiter`-separated; blank lines are skipped and every
+// row must have as many fields as the first one. A seekable stream is read
+// twice, first only to count the rows, so that values are parsed straight
+// into a result allocated at its final size.
+S21Matrix ReadCsv(std::istream& in, char delimiter = ',',
+                  size_t buffer_size = kIoBufferSize);
+S21Matrix ReadCsv(const std::string& path, char delimiter = ',');
+void WriteCsv(const S21Matrix& matrix, std::ostream& out,
+              char delimiter = ',');
+void WriteCsv(const S21Matrix& matrix, const std::string& path,
+              char delimiter = ',');
+
+// Matrix Market exchange format: "array" (dense, column-major) or
+// "coordinate" (one "row col value" line per nonzero, 1-based).
+enum class MatrixMarketFormat { kArray, kCoordinate };
+
+// Reads real, integer and (coordinate only) pattern matrices with general,
+// symmetric or skew-symmetric storage.
+S21Matrix ReadMatrixMarket(std::istream& in,
+                           size_t buffer_size = kIoBufferSize);
+S21Matrix ReadMatrixMarket(const std::string& path);
+void WriteMatrixMarket(const S21Matrix& matrix, std::ostream& out,
+                       MatrixMarketFormat format = MatrixMarketFormat::kArray);
+void WriteMatrixMarket(const S21Matrix& matrix, const std::string& path,
+                       MatrixMarketFormat format = MatrixMarketFormat::kArray);
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,139 @@
+#include "s21_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+
+namespace s21 {
+
+namespace {
+
+int defaultWorkers() {
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  if (const char *env = std::getenv("S21_NUM_THREADS")) {
+    int requested = std::atoi(env);
+    if (requested > 0) threads = requested;
+  }
+  // The caller of ParallelFor always takes part, so it is not counted.
+  return std::max(threads - 1, 1);
+}
+
+struct ForState {
+  const std::function<void(size_t, size_t)> *body = nullptr;
+  size_t begin = 0, end = 0, chunk = 0, chunks = 0;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::exception_ptr error;
+  std::stop_token stop;
+};
+
+// Claims chunks until none are left. Returns once this thread has nothing
+// more to do; the body is only touched while a claimed chunk is pending, so
+// the caller's stack frame is guaranteed to still be alive.
+void drain(const std::shared_ptr<ForState> &state) {
+  StopTokenScope scope(state->stop);
+  for (;;) {
+    const size_t index = state->next.fetch_add(1);
+    if (index >= state->chunks) return;
+    const size_t lo = state->begin + index * state->chunk;
+    const size_t hi = std::min(state->end, lo + state->chunk);
+    try {
+      ThrowIfCancelled();
+      (*state->body)(lo, hi);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->error) state->error = std::current_exception();
+    }
+    if (state->done.fetch_add(1) + 1 == state->chunks) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->cv.notify_all();
+    }
+  }
+}
+
+}  // namespace
+
+ThreadPool &ThreadPool::Instance() {
+  static ThreadPool pool(defaultWorkers());
+  return pool;
+}
+
+ThreadPool::ThreadPool(int workers) : stop_(false) {
+  for (int i = 0; i < workers; i++) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread &worker : workers_) worker.join();
+}
+
+void ThreadPool::workerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (stop_ && tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+int ThreadPool::Concurrency() const noexcept {
+  return static_cast<int>(workers_.size()) + 1;
+}
+
+void ParallelFor(size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)> &body) {
+  if (end <= begin) return;
+  ThreadPool &pool = ThreadPool::Instance();
+  const size_t count = end - begin;
+  grain = std::max<size_t>(grain, 1);
+  const size_t threads = static_cast<size_t>(pool.Concurrency());
+  if (threads == 1 || count <= grain) {
+    body(begin, end);
+    return;
+  }
+
+  // A few chunks per thread keeps the load balanced without much overhead.
+  const size_t chunks = std::min((count + grain - 1) / grain, threads * 4);
+  auto state = std::make_shared<ForState>();
+  state->body = &body;
+  state->begin = begin;
+  state->end = end;
+  state->chunk = (count + chunks - 1) / chunks;
+  state->chunks = (count + state->chunk - 1) / state->chunk;
+  state->stop = current_stop_token;
+
+  const size_t helpers = std::min(threads, state->chunks) - 1;
+  for (size_t i = 0; i < helpers; i++) {
+    pool.Submit([state] { drain(state); });
+  }
+  drain(state);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&] { return state->done.load() == state->chunks; });
+  if (state->error) std::rethrow_exception(state->error);
+}
+
+}  // namespace s21
@@ -0,0 +1,82 @@
+#ifndef S21_PARALLEL_H
+#define S21_PARALLEL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+// Process-wide worker pool shared by every parallel kernel and by the async
+// API of the library. The size defaults to the number of hardware threads
+// and can be overridden with the S21_NUM_THREADS environment variable; there
+// is always at least one worker so async tasks never run on the caller.
+class ThreadPool {
+ public:
+  static ThreadPool& Instance();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void Submit(std::function<void()> task);
+  // Number of threads that can run work at once, including the caller.
+  int Concurrency() const noexcept;
+
+ private:
+  explicit ThreadPool(int workers);
+  ~ThreadPool();
+  void workerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_;
+};
+
+// Runs body(chunk_begin, chunk_end) over [begin, end) split into chunks of
+// at least `grain` indices. The calling thread works on chunks too, so a
+// ParallelFor issued from inside a pool task cannot deadlock. The first
+// exception thrown by body is rethrown to the caller.
+void ParallelFor(size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body);
+
+// Thrown by a kernel that noticed its stop token was triggered.
+class OperationCancelled : public std::runtime_error {
+ public:
+  OperationCancelled() : std::runtime_error("ERROR: operation cancelled") {}
+};
+
+// Stop token of the operation the current thread is working on. Async tasks
+// install it and ParallelFor forwards it to the helpers of the caller.
+inline thread_local std::stop_token current_stop_token;
+
+// Installs a stop token for the lifetime of the scope.
+class StopTokenScope {
+ public:
+  explicit StopTokenScope(std::stop_token token)
+      : saved_(std::move(current_stop_token)) {
+    current_stop_token = std::move(token);
+  }
+  ~StopTokenScope() { current_stop_token = std::move(saved_); }
+  StopTokenScope(const StopTokenScope&) = delete;
+  StopTokenScope& operator=(const StopTokenScope&) = delete;
+
+ private:
+  std::stop_token saved_;
+};
+
+// Cancellation point for long-running kernels.
+inline void ThrowIfCancelled() {
+  if (current_stop_token.stop_requested()) throw OperationCancelled();
+}
+
+}  // namespace s21
+
+#endif
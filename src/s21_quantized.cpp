@@ -0,0 +1,279 @@
+#include "s21_quantized.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "s21_parallel.h"
+#include "s21_tuning.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define S21_QUANT_X86 1
+#endif
+
+namespace {
+
+// int8_t dot products are summed in int32 over blocks of this many
+// elements: 2^16 * 128 * 128 = 2^30 cannot overflow.
+constexpr size_t kInt8Block = 1 << 16;
+
+template <typename T>
+struct QuantRange;
+template <>
+struct QuantRange<int8_t> {
+  static constexpr int kMin = -128, kMax = 127;
+};
+template <>
+struct QuantRange<int16_t> {
+  static constexpr int kMin = -32767, kMax = 32767;
+};
+
+template <typename Body>
+void forEachRow(size_t rows, size_t row_cost, const Body &body) {
+  const s21::Tunables &tuning = s21::Tuning();
+  if (rows * row_cost < tuning.quantized_parallel_threshold) {
+    body(size_t{0}, rows);
+  } else {
+    s21::ParallelFor(
+        0, rows, std::max<size_t>(1, tuning.parallel_grain / row_cost), body);
+  }
+}
+
+int64_t dotPortable(const int8_t *a, const int8_t *b, size_t k) {
+  int64_t total = 0;
+  for (size_t first = 0; first < k; first += kInt8Block) {
+    const size_t last = std::min(k, first + kInt8Block);
+    int32_t sum = 0;
+    for (size_t p = first; p < last; p++) sum += a[p] * b[p];
+    total += sum;
+  }
+  return total;
+}
+
+int64_t dotPortable(const int16_t *a, const int16_t *b, size_t k) {
+  int64_t total = 0;
+  for (size_t p = 0; p < k; p++) total += int32_t{a[p]} * b[p];
+  return total;
+}
+
+#ifdef S21_QUANT_X86
+
+// maddubs multiplies unsigned by signed bytes and saturates, so signed
+// int8_t operands are sign-extended to 16 bits and fed to madd_epi16, which
+// sums adjacent products exactly into int32 lanes.
+__attribute__((target("avx2"))) int64_t dotAvx2(const int8_t *a,
+                                                const int8_t *b, size_t k) {
+  int64_t total = 0;
+  size_t p = 0;
+  while (p + 16 <= k) {
+    const size_t block_end = std::min(k, p + kInt8Block);
+    __m256i acc = _mm256_setzero_si256();
+    for (; p + 16 <= block_end; p += 16) {
+      const __m256i va = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + p)));
+      const __m256i vb = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + p)));
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+    for (int32_t lane : lanes) total += lane;
+  }
+  return total + dotPortable(a + p, b + p, k - p);
+}
+
+// Pair sums of int16_t products stay below 2^31 for |q| <= 32767 and are
+// widened to int64 right away.
+__attribute__((target("avx2"))) int64_t dotAvx2(const int16_t *a,
+                                                const int16_t *b, size_t k) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t p = 0;
+  for (; p + 16 <= k; p += 16) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + p));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + p));
+    const __m256i pairs = _mm256_madd_epi16(va, vb);
+    acc = _mm256_add_epi64(
+        acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+    acc = _mm256_add_epi64(
+        acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+         dotPortable(a + p, b + p, k - p);
+}
+
+bool haveAvx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+
+#endif
+
+template <typename T>
+int64_t dot(const T *a, const T *b, size_t k) {
+#ifdef S21_QUANT_X86
+  if (haveAvx2()) return dotAvx2(a, b, k);
+#endif
+  return dotPortable(a, b, k);
+}
+
+}  // namespace
+
+template <typename T>
+S21QuantizedMatrix<T>::S21QuantizedMatrix(const S21Matrix &other,
+                                          S21QuantScheme scheme)
+    : rows_(other.GetRows()), cols_(other.GetCols()) {
+  if (other.data() == nullptr) {
+    throw std::invalid_argument("ERROR: Matrix is not initialized");
+  }
+  quantize(other.data(), cols_, 1, scheme);
+}
+
+template <typename T>
+S21QuantizedMatrix<T> S21QuantizedMatrix<T>::FromColumns(
+    const S21Matrix &other, S21QuantScheme scheme) {
+  if (other.data() == nullptr) {
+    throw std::invalid_argument("ERROR: Matrix is not initialized");
+  }
+  S21QuantizedMatrix result;
+  result.rows_ = other.GetCols();
+  result.cols_ = other.GetRows();
+  result.by_columns_ = true;
+  result.quantize(other.data(), 1, other.GetCols(), scheme);
+  return result;
+}
+
+template <typename T>
+void S21QuantizedMatrix<T>::quantize(const double *a, size_t row_stride,
+                                     size_t col_stride,
+                                     S21QuantScheme scheme) {
+  constexpr int kMin = QuantRange<T>::kMin, kMax = QuantRange<T>::kMax;
+  const size_t rows = rows_, cols = cols_;
+
+  // Per-row ranges, widened to include 0 so that zero is represented exactly.
+  std::vector<double> lo(rows), hi(rows);
+  forEachRow(rows, cols, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      double row_lo = 0.0, row_hi = 0.0;
+      for (size_t j = 0; j < cols; j++) {
+        const double x = a[i * row_stride + j * col_stride];
+        row_lo = std::min(row_lo, x);
+        row_hi = std::max(row_hi, x);
+      }
+      lo[i] = row_lo;
+      hi[i] = row_hi;
+    }
+  });
+  if (scheme == S21QuantScheme::kPerTensor) {
+    lo.assign(1, *std::min_element(lo.begin(), lo.end()));
+    hi.assign(1, *std::max_element(hi.begin(), hi.end()));
+  }
+
+  scales_.resize(lo.size());
+  zero_points_.resize(lo.size());
+  for (size_t g = 0; g < lo.size(); g++) {
+    if (!std::isfinite(lo[g]) || !std::isfinite(hi[g])) {
+      throw std::invalid_argument("ERROR: cannot quantize non-finite values");
+    }
+    const double range = hi[g] - lo[g];
+    scales_[g] = range > 0.0 ? range / (kMax - kMin) : 1.0;
+    zero_points_[g] = static_cast<int32_t>(std::clamp<double>(
+        std::nearbyint(kMin - lo[g] / scales_[g]), kMin, kMax));
+  }
+
+  data_.resize(rows * cols);
+  row_sums_.resize(rows);
+  forEachRow(rows, cols, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const double inv_scale = 1.0 / scales_[group(i)];
+      const double zero_point = zero_points_[group(i)];
+      T *q = data_.data() + i * cols;
+      int64_t sum = 0;
+      for (size_t j = 0; j < cols; j++) {
+        const double x = a[i * row_stride + j * col_stride];
+        q[j] = static_cast<T>(std::clamp<double>(
+            std::nearbyint(x * inv_scale) + zero_point, kMin, kMax));
+        sum += q[j];
+      }
+      row_sums_[i] = sum;
+    }
+  });
+}
+
+template <typename T>
+double S21QuantizedMatrix<T>::Scale(int i) const {
+  if (i < 0 || i >= rows_) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return scales_[group(i)];
+}
+
+template <typename T>
+int S21QuantizedMatrix<T>::ZeroPoint(int i) const {
+  if (i < 0 || i >= rows_) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return zero_points_[group(i)];
+}
+
+template <typename T>
+S21Matrix S21QuantizedMatrix<T>::Dequantize() const {
+  if (data_.empty()) return S21Matrix();
+  S21Matrix result(GetRows(), GetCols(), S21Matrix::uninitialized);
+  double *out = result.data();
+  const size_t cols = cols_;
+  const size_t row_stride = by_columns_ ? 1 : cols_;
+  const size_t col_stride = by_columns_ ? rows_ : 1;
+  forEachRow(rows_, cols, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const double scale = scales_[group(i)];
+      const int32_t zero_point = zero_points_[group(i)];
+      for (size_t j = 0; j < cols; j++) {
+        out[i * row_stride + j * col_stride] =
+            scale * (data_[i * cols + j] - zero_point);
+      }
+    }
+  });
+  return result;
+}
+
+// C_ij = sa_i * sb_j * sum_p (qa_ip - za_i) * (qb_jp - zb_j), expanded so
+// the inner loop is a plain integer dot product:
+//   dot(qa_i, qb_j) - za_i * sum(qb_j) - zb_j * sum(qa_i) + k * za_i * zb_j.
+template <typename T>
+S21Matrix S21QuantizedMatrix<T>::MulMatrix(
+    const S21QuantizedMatrix &other) const {
+  if (by_columns_ || !other.by_columns_) {
+    throw std::invalid_argument(
+        "ERROR: right operand must be quantized with FromColumns");
+  }
+  if (data_.empty() || other.data_.empty() || cols_ != other.cols_) {
+    throw std::invalid_argument("ERROR: incompatible matrix sizes");
+  }
+  const size_t m = rows_, n = other.rows_, k = cols_;
+  S21Matrix result(rows_, other.rows_, S21Matrix::uninitialized);
+  double *out = result.data();
+  forEachRow(m, n * k, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+      s21::ThrowIfCancelled();
+      const T *qa = data_.data() + i * k;
+      const int64_t za = zero_points_[group(i)];
+      const double sa = scales_[group(i)];
+      for (size_t j = 0; j < n; j++) {
+        const int64_t zb = other.zero_points_[other.group(j)];
+        const int64_t acc = dot(qa, other.data_.data() + j * k, k) -
+                            za * other.row_sums_[j] - zb * row_sums_[i] +
+                            static_cast<int64_t>(k) * za * zb;
+        out[i * n + j] = sa * other.scales_[other.group(j)] * acc;
+      }
+    }
+  });
+  return result;
+}
+
+template class S21QuantizedMatrix<int8_t>;
+template class S21QuantizedMatrix<int16_t>;
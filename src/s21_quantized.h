@@ -0,0 +1,71 @@
+#ifndef S21_QUANTIZED_H
+#define S21_QUANTIZED_H
+
+#include <cstdint>
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Granularity of the affine quantization parameters.
+enum class S21QuantScheme { kPerTensor, kPerRow };
+
+// Affine-quantized matrix, x ~ scale * (q - zero_point), with an int8_t or
+// int16_t element type. Every quantization group (the whole matrix, or one
+// stored row) gets the scale and zero point that map its [min, max] range,
+// widened to include 0, onto the integer range, so each element is off by at
+// most scale / 2. int8_t uses [-128, 127]; int16_t uses [-32767, 32767] so
+// that two products always fit an int32 pair sum.
+//
+// MulMatrix multiplies in integers: int8_t products accumulate in int32
+// (in blocks, widened to int64 between them), int16_t pair sums in int64.
+// With A quantized by rows and B by columns, the dequantized product obeys
+//   |C - A * B|_ij <= sa_i / 2 * sum_p |B_pj| + sb_j / 2 * sum_p |A_ip|
+//                     + k * sa_i * sb_j / 4.
+template <typename T>
+class S21QuantizedMatrix {
+ public:
+  S21QuantizedMatrix() noexcept = default;
+  explicit S21QuantizedMatrix(
+      const S21Matrix& other,
+      S21QuantScheme scheme = S21QuantScheme::kPerTensor);
+  // Quantizes the columns of `other` and stores them as rows: the layout of
+  // the right-hand operand of MulMatrix. kPerRow then means per column.
+  static S21QuantizedMatrix FromColumns(
+      const S21Matrix& other,
+      S21QuantScheme scheme = S21QuantScheme::kPerTensor);
+
+  int GetRows() const noexcept { return by_columns_ ? cols_ : rows_; }
+  int GetCols() const noexcept { return by_columns_ ? rows_ : cols_; }
+  bool ByColumns() const noexcept { return by_columns_; }
+
+  // Parameters of stored row i (a column of the matrix when ByColumns()).
+  double Scale(int i) const;
+  int ZeroPoint(int i) const;
+
+  // Stored rows of quantized values, row-major.
+  const T* data() const noexcept { return data_.data(); }
+
+  S21Matrix Dequantize() const;
+  // Dequantized this * other; `other` must come from FromColumns.
+  S21Matrix MulMatrix(const S21QuantizedMatrix& other) const;
+
+ private:
+  int rows_ = 0, cols_ = 0;  // stored shape
+  bool by_columns_ = false;
+  std::vector<T> data_;
+  std::vector<double> scales_;     // one per group
+  std::vector<int32_t> zero_points_;
+  std::vector<int64_t> row_sums_;  // sum of q over each stored row
+
+  void quantize(const double* a, size_t row_stride, size_t col_stride,
+                S21QuantScheme scheme);
+  size_t group(int i) const noexcept { return scales_.size() == 1 ? 0 : i; }
+};
+
+using S21QuantizedMatrix8 = S21QuantizedMatrix<int8_t>;
+using S21QuantizedMatrix16 = S21QuantizedMatrix<int16_t>;
+
+extern template class S21QuantizedMatrix<int8_t>;
+extern template class S21QuantizedMatrix<int16_t>;
+
+#endif
@@ -0,0 +1,376 @@
+#include "s21_solvers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "s21_backend.h"
+#include "s21_parallel.h"
+
+namespace s21 {
+
+namespace {
+
+double dot(std::span<const double> x, std::span<const double> y) {
+  double sum = 0.0;
+  for (size_t i = 0; i < x.size(); i++) sum += x[i] * y[i];
+  return sum;
+}
+
+double norm(std::span<const double> x) { return std::sqrt(dot(x, x)); }
+
+// y += alpha * x
+void axpy(double alpha, std::span<const double> x, std::span<double> y) {
+  for (size_t i = 0; i < x.size(); i++) y[i] += alpha * x[i];
+}
+
+void precondition(const Preconditioner &m, std::span<const double> r,
+                  std::span<double> z) {
+  if (m) {
+    m(r, z);
+  } else {
+    std::copy(r.begin(), r.end(), z.begin());
+  }
+}
+
+void checkSizes(std::span<const double> b, std::span<double> x,
+                const SolverOptions &options) {
+  if (b.size() != x.size()) {
+    throw std::invalid_argument("ERROR: b and x must have the same size");
+  }
+  if (options.max_iterations < 0 || options.restart <= 0 ||
+      !(options.tolerance >= 0.0)) {
+    throw std::invalid_argument("ERROR: invalid solver options");
+  }
+}
+
+LinearOperator matrixOperator(const S21Matrix &a, size_t n) {
+  if (a.GetRows() != a.GetCols() || static_cast<size_t>(a.GetRows()) != n) {
+    throw std::invalid_argument("ERROR: A must be square and match b");
+  }
+  const double *data = a.data();
+  const int size = static_cast<int>(n);
+  return [data, size](std::span<const double> x, std::span<double> y) {
+    CurrentBackend().Gemv(false, size, size, 1.0, data, size, x.data(), 0.0,
+                          y.data());
+  };
+}
+
+// r = b - A x; returns ||r|| / ||b||.
+double residual(const LinearOperator &a, std::span<const double> b,
+                std::span<const double> x, std::span<double> r,
+                double b_norm) {
+  a(x, r);
+  for (size_t i = 0; i < r.size(); i++) r[i] = b[i] - r[i];
+  return norm(r) / b_norm;
+}
+
+// Records the residual of one more iteration; true once it is small enough.
+bool record(SolverResult &result, double relative,
+            const SolverOptions &options) {
+  result.residual = relative;
+  result.residual_history.push_back(relative);
+  result.converged = relative <= options.tolerance;
+  return result.converged;
+}
+
+// Starts a solve: sizes the history and handles b == 0, where x = 0 is
+// exact. Returns ||b||, or 0 when the solve is already done.
+double start(SolverResult &result, std::span<const double> b,
+             std::span<double> x, const SolverOptions &options) {
+  checkSizes(b, x, options);
+  result.residual_history.reserve(options.max_iterations + 1);
+  const double b_norm = norm(b);
+  if (b_norm == 0.0) {
+    std::fill(x.begin(), x.end(), 0.0);
+    record(result, 0.0, options);
+  }
+  return b_norm;
+}
+
+}  // namespace
+
+/* -------------- CONJUGATE GRADIENT -------------- */
+
+SolverResult ConjugateGradient(const LinearOperator &a,
+                               std::span<const double> b, std::span<double> x,
+                               const SolverOptions &options,
+                               const Preconditioner &m) {
+  SolverResult result;
+  const double b_norm = start(result, b, x, options);
+  if (b_norm == 0.0) return result;
+
+  const size_t n = b.size();
+  std::vector<double> work(4 * n);
+  std::span<double> r(work.data(), n), z(work.data() + n, n),
+      p(work.data() + 2 * n, n), ap(work.data() + 3 * n, n);
+
+  if (record(result, residual(a, b, x, r, b_norm), options)) return result;
+  precondition(m, r, z);
+  std::copy(z.begin(), z.end(), p.begin());
+  double rz = dot(r, z);
+
+  while (result.iterations < options.max_iterations) {
+    ThrowIfCancelled();
+    a(p, ap);
+    const double curvature = dot(p, ap);
+    if (curvature == 0.0) break;
+    const double alpha = rz / curvature;
+    axpy(alpha, p, x);
+    axpy(-alpha, ap, r);
+    result.iterations++;
+    if (record(result, norm(r) / b_norm, options)) break;
+
+    precondition(m, r, z);
+    const double rz_next = dot(r, z);
+    const double beta = rz_next / rz;
+    rz = rz_next;
+    for (size_t i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+  }
+  return result;
+}
+
+SolverResult ConjugateGradient(const S21Matrix &a, std::span<const double> b,
+                               std::span<double> x,
+                               const SolverOptions &options,
+                               const Preconditioner &m) {
+  return ConjugateGradient(matrixOperator(a, b.size()), b, x, options, m);
+}
+
+/* -------------- BICGSTAB -------------- */
+
+SolverResult BiCgStab(const LinearOperator &a, std::span<const double> b,
+                      std::span<double> x, const SolverOptions &options,
+                      const Preconditioner &m) {
+  SolverResult result;
+  const double b_norm = start(result, b, x, options);
+  if (b_norm == 0.0) return result;
+
+  const size_t n = b.size();
+  std::vector<double> work(8 * n, 0.0);
+  std::span<double> r(work.data(), n), r_hat(work.data() + n, n),
+      p(work.data() + 2 * n, n), v(work.data() + 3 * n, n),
+      p_hat(work.data() + 4 * n, n), s(work.data() + 5 * n, n),
+      s_hat(work.data() + 6 * n, n), t(work.data() + 7 * n, n);
+
+  if (record(result, residual(a, b, x, r, b_norm), options)) return result;
+  std::copy(r.begin(), r.end(), r_hat.begin());
+  double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+  while (result.iterations < options.max_iterations) {
+    ThrowIfCancelled();
+    const double rho_next = dot(r_hat, r);
+    if (rho_next == 0.0) break;  // breakdown: r is orthogonal to r_hat
+    const double beta = (rho_next / rho) * (alpha / omega);
+    rho = rho_next;
+    for (size_t i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+    precondition(m, p, p_hat);
+    a(p_hat, v);
+    const double r_hat_v = dot(r_hat, v);
+    if (r_hat_v == 0.0) break;
+    alpha = rho / r_hat_v;
+    for (size_t i = 0; i < n; i++) s[i] = r[i] - alpha * v[i];
+    result.iterations++;
+    if (norm(s) / b_norm <= options.tolerance) {
+      axpy(alpha, p_hat, x);
+      record(result, norm(s) / b_norm, options);
+      break;
+    }
+
+    precondition(m, s, s_hat);
+    a(s_hat, t);
+    const double tt = dot(t, t);
+    omega = tt == 0.0 ? 0.0 : dot(t, s) / tt;
+    axpy(alpha, p_hat, x);
+    axpy(omega, s_hat, x);
+    for (size_t i = 0; i < n; i++) r[i] = s[i] - omega * t[i];
+    if (record(result, norm(r) / b_norm, options) || omega == 0.0) break;
+  }
+  return result;
+}
+
+SolverResult BiCgStab(const S21Matrix &a, std::span<const double> b,
+                      std::span<double> x, const SolverOptions &options,
+                      const Preconditioner &m) {
+  return BiCgStab(matrixOperator(a, b.size()), b, x, options, m);
+}
+
+/* -------------- GMRES -------------- */
+
+SolverResult Gmres(const LinearOperator &a, std::span<const double> b,
+                   std::span<double> x, const SolverOptions &options,
+                   const Preconditioner &m) {
+  SolverResult result;
+  const double b_norm = start(result, b, x, options);
+  if (b_norm == 0.0) return result;
+
+  const size_t n = b.size();
+  const size_t restart = std::min<size_t>(options.restart, n);
+  // Arnoldi basis v_0 .. v_restart, Hessenberg matrix (column-major,
+  // restart + 1 rows), Givens rotations and the rotated right-hand side.
+  std::vector<double> basis((restart + 1) * n), h((restart + 1) * restart);
+  std::vector<double> cs(restart), sn(restart), g(restart + 1), y(restart);
+  std::vector<double> work(2 * n);
+  std::span<double> w(work.data(), n), z(work.data() + n, n);
+  auto v = [&](size_t j) { return std::span<double>(&basis[j * n], n); };
+
+  double relative = residual(a, b, x, v(0), b_norm);
+  if (record(result, relative, options)) return result;
+
+  while (result.iterations < options.max_iterations) {
+    // v(0) holds the current residual r.
+    const double beta = norm(v(0));
+    for (double &value : v(0)) value /= beta;
+    std::fill(g.begin(), g.end(), 0.0);
+    g[0] = beta;
+
+    size_t k = 0;  // basis vectors added in this cycle
+    while (k < restart && result.iterations < options.max_iterations) {
+      ThrowIfCancelled();
+      precondition(m, v(k), z);
+      a(z, w);
+      double *column = &h[k * (restart + 1)];
+      // Modified Gram-Schmidt.
+      for (size_t i = 0; i <= k; i++) {
+        column[i] = dot(w, v(i));
+        axpy(-column[i], v(i), w);
+      }
+      column[k + 1] = norm(w);
+      // A vanishing new basis vector means the subspace is invariant and
+      // the least-squares solution below is exact.
+      const bool invariant = column[k + 1] == 0.0;
+      if (!invariant) {
+        for (size_t i = 0; i < n; i++) v(k + 1)[i] = w[i] / column[k + 1];
+      }
+      for (size_t i = 0; i < k; i++) {
+        const double rotated = cs[i] * column[i] + sn[i] * column[i + 1];
+        column[i + 1] = -sn[i] * column[i] + cs[i] * column[i + 1];
+        column[i] = rotated;
+      }
+      const double radius = std::hypot(column[k], column[k + 1]);
+      cs[k] = radius == 0.0 ? 1.0 : column[k] / radius;
+      sn[k] = radius == 0.0 ? 0.0 : column[k + 1] / radius;
+      column[k] = radius;
+      column[k + 1] = 0.0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      k++;
+      result.iterations++;
+      if (record(result, std::fabs(g[k]) / b_norm, options) || invariant) {
+        break;
+      }
+    }
+
+    // y = H^-1 g, x += M^-1 (V y).
+    for (size_t i = k; i-- > 0;) {
+      double sum = g[i];
+      for (size_t j = i + 1; j < k; j++) sum -= h[j * (restart + 1) + i] * y[j];
+      const double diagonal = h[i * (restart + 1) + i];
+      y[i] = diagonal == 0.0 ? 0.0 : sum / diagonal;
+    }
+    std::fill(w.begin(), w.end(), 0.0);
+    for (size_t j = 0; j < k; j++) axpy(y[j], v(j), w);
+    precondition(m, w, z);
+    axpy(1.0, z, x);
+
+    // Restart from the true residual, which also corrects the estimate.
+    relative = residual(a, b, x, v(0), b_norm);
+    result.residual = relative;
+    result.converged = relative <= options.tolerance;
+    if (result.converged) break;
+  }
+  return result;
+}
+
+SolverResult Gmres(const S21Matrix &a, std::span<const double> b,
+                   std::span<double> x, const SolverOptions &options,
+                   const Preconditioner &m) {
+  return Gmres(matrixOperator(a, b.size()), b, x, options, m);
+}
+
+/* -------------- PRECONDITIONERS -------------- */
+
+JacobiPreconditioner::JacobiPreconditioner(const S21Matrix &a) {
+  if (a.GetRows() <= 0 || a.GetRows() != a.GetCols()) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+  inverse_diagonal_.resize(a.GetRows());
+  for (int i = 0; i < a.GetRows(); i++) {
+    if (a(i, i) == 0.0) {
+      throw std::invalid_argument("ERROR: zero on the diagonal");
+    }
+    inverse_diagonal_[i] = 1.0 / a(i, i);
+  }
+}
+
+void JacobiPreconditioner::operator()(std::span<const double> r,
+                                      std::span<double> z) const {
+  for (size_t i = 0; i < r.size(); i++) z[i] = r[i] * inverse_diagonal_[i];
+}
+
+Ilu0Preconditioner::Ilu0Preconditioner(const S21Matrix &a) {
+  const int n = a.GetRows();
+  if (n <= 0 || n != a.GetCols()) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+  row_start_.reserve(n + 1);
+  row_start_.push_back(0);
+  diagonal_.resize(n);
+  for (int i = 0; i < n; i++) {
+    if (a(i, i) == 0.0) {
+      throw std::invalid_argument("ERROR: zero on the diagonal");
+    }
+    for (int j = 0; j < n; j++) {
+      if (a(i, j) == 0.0) continue;
+      if (j == i) diagonal_[i] = static_cast<int>(values_.size());
+      cols_.push_back(j);
+      values_.push_back(a(i, j));
+    }
+    row_start_.push_back(static_cast<int>(values_.size()));
+  }
+
+  // IKJ elimination restricted to the pattern; `where` maps the columns of
+  // row i to their slots.
+  std::vector<int> where(n, -1);
+  for (int i = 1; i < n; i++) {
+    for (int s = row_start_[i]; s < row_start_[i + 1]; s++) {
+      where[cols_[s]] = s;
+    }
+    for (int s = row_start_[i]; s < diagonal_[i]; s++) {
+      const int k = cols_[s];
+      values_[s] /= values_[diagonal_[k]];
+      const double l = values_[s];
+      for (int t = diagonal_[k] + 1; t < row_start_[k + 1]; t++) {
+        if (where[cols_[t]] >= 0) values_[where[cols_[t]]] -= l * values_[t];
+      }
+    }
+    if (values_[diagonal_[i]] == 0.0) {
+      throw std::invalid_argument("ERROR: zero pivot in ILU(0)");
+    }
+    for (int s = row_start_[i]; s < row_start_[i + 1]; s++) {
+      where[cols_[s]] = -1;
+    }
+  }
+}
+
+void Ilu0Preconditioner::operator()(std::span<const double> r,
+                                    std::span<double> z) const {
+  const int n = static_cast<int>(diagonal_.size());
+  for (int i = 0; i < n; i++) {
+    double sum = r[i];
+    for (int s = row_start_[i]; s < diagonal_[i]; s++) {
+      sum -= values_[s] * z[cols_[s]];
+    }
+    z[i] = sum;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    double sum = z[i];
+    for (int s = diagonal_[i] + 1; s < row_start_[i + 1]; s++) {
+      sum -= values_[s] * z[cols_[s]];
+    }
+    z[i] = sum / values_[diagonal_[i]];
+  }
+}
+
+}  // namespace s21
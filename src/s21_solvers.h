@@ -0,0 +1,91 @@
+#ifndef S21_SOLVERS_H
+#define S21_SOLVERS_H
+
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Krylov solvers for A x = b where A is only available as a product
+// y = A x: a matrix-free callable, or an S21Matrix. `x` holds the initial
+// guess on entry and the solution on return. All work vectors and the
+// residual history are allocated before the first iteration, so the solvers
+// allocate nothing while iterating (a large S21Matrix product still goes
+// through ParallelFor, which allocates its own bookkeeping).
+namespace s21 {
+
+// y = A x, with x.size() == y.size() == n.
+using LinearOperator =
+    std::function<void(std::span<const double> x, std::span<double> y)>;
+// z = M^-1 r for a preconditioner M ~ A. An empty function is the identity.
+// Large preconditioners are best passed as std::cref(...) to avoid a copy.
+using Preconditioner =
+    std::function<void(std::span<const double> r, std::span<double> z)>;
+
+struct SolverOptions {
+  double tolerance = 1e-10;  // on the relative residual ||b - Ax|| / ||b||
+  int max_iterations = 1000;
+  int restart = 30;  // Krylov subspace size of GMRES between restarts
+};
+
+struct SolverResult {
+  bool converged = false;
+  int iterations = 0;
+  double residual = 0.0;  // final relative residual
+  // Relative residual before the first iteration and after every one; for
+  // GMRES the cheap estimate from the Hessenberg least-squares problem.
+  std::vector<double> residual_history;
+};
+
+// Conjugate gradients, for symmetric positive definite A and M.
+SolverResult ConjugateGradient(const LinearOperator& a,
+                               std::span<const double> b, std::span<double> x,
+                               const SolverOptions& options = {},
+                               const Preconditioner& m = {});
+SolverResult ConjugateGradient(const S21Matrix& a, std::span<const double> b,
+                               std::span<double> x,
+                               const SolverOptions& options = {},
+                               const Preconditioner& m = {});
+
+// BiCGSTAB, right-preconditioned, for general nonsingular A.
+SolverResult BiCgStab(const LinearOperator& a, std::span<const double> b,
+                      std::span<double> x, const SolverOptions& options = {},
+                      const Preconditioner& m = {});
+SolverResult BiCgStab(const S21Matrix& a, std::span<const double> b,
+                      std::span<double> x, const SolverOptions& options = {},
+                      const Preconditioner& m = {});
+
+// Restarted GMRES(options.restart), right-preconditioned, for general A.
+SolverResult Gmres(const LinearOperator& a, std::span<const double> b,
+                   std::span<double> x, const SolverOptions& options = {},
+                   const Preconditioner& m = {});
+SolverResult Gmres(const S21Matrix& a, std::span<const double> b,
+                   std::span<double> x, const SolverOptions& options = {},
+                   const Preconditioner& m = {});
+
+// M = diag(A).
+class JacobiPreconditioner {
+ public:
+  explicit JacobiPreconditioner(const S21Matrix& a);
+  void operator()(std::span<const double> r, std::span<double> z) const;
+
+ private:
+  std::vector<double> inverse_diagonal_;
+};
+
+// Incomplete LU without fill-in: L and U keep the nonzero pattern of A,
+// stored in compressed sparse rows.
+class Ilu0Preconditioner {
+ public:
+  explicit Ilu0Preconditioner(const S21Matrix& a);
+  void operator()(std::span<const double> r, std::span<double> z) const;
+
+ private:
+  std::vector<int> row_start_, cols_, diagonal_;
+  std::vector<double> values_;
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,536 @@
+#include "s21_structured.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+void checkSize(int n) {
+  if (n <= 0) {
+    throw std::domain_error(
+        "ERROR: Rows and columns must be greater than zero");
+  }
+}
+
+void checkSquare(const S21Matrix &m) {
+  if (m.GetRows() <= 0 || m.GetRows() != m.GetCols()) {
+    throw std::invalid_argument("ERROR: matrix must be square");
+  }
+}
+
+void checkIndex(int n, int i, int j) {
+  if (i < 0 || j < 0 || i >= n || j >= n) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+}
+
+[[noreturn]] void throwStructuralZero() {
+  throw std::domain_error("ERROR: entry is fixed at zero by the structure");
+}
+
+void checkRows(int n, const S21Matrix &b) {
+  if (b.GetRows() != n) {
+    throw std::invalid_argument("ERROR: right-hand side has the wrong shape");
+  }
+}
+
+void checkCols(const S21Matrix &m, int n) {
+  if (m.GetCols() != n) {
+    throw std::invalid_argument("ERROR");
+  }
+}
+
+}  // namespace
+
+/* -------------- DIAGONAL -------------- */
+
+S21DiagonalMatrix::S21DiagonalMatrix(int n) {
+  checkSize(n);
+  diag_.assign(n, 0.0);
+}
+
+S21DiagonalMatrix::S21DiagonalMatrix(const S21Matrix &other) {
+  checkSquare(other);
+  diag_.resize(other.GetRows());
+  for (int i = 0; i < other.GetRows(); i++) diag_[i] = other.At(i, i);
+}
+
+double S21DiagonalMatrix::operator()(int i, int j) const {
+  checkIndex(GetSize(), i, j);
+  return i == j ? diag_[i] : 0.0;
+}
+
+double &S21DiagonalMatrix::operator()(int i, int j) {
+  checkIndex(GetSize(), i, j);
+  if (i != j) throwStructuralZero();
+  return diag_[i];
+}
+
+S21Matrix S21DiagonalMatrix::ToMatrix() const {
+  S21Matrix result(GetSize(), GetSize());
+  for (int i = 0; i < GetSize(); i++) result.At(i, i) = diag_[i];
+  return result;
+}
+
+double S21DiagonalMatrix::Determinant() const {
+  double det = 1.0;
+  for (double d : diag_) det *= d;
+  return det;
+}
+
+S21DiagonalMatrix S21DiagonalMatrix::InverseMatrix() const {
+  S21DiagonalMatrix result(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    if (diag_[i] == 0.0) {
+      throw std::invalid_argument(
+          "ERROR: The determinant of this matrix is 0. The inverse matrix "
+          "does not exist.");
+    }
+    result.diag_[i] = 1.0 / diag_[i];
+  }
+  return result;
+}
+
+S21Matrix S21DiagonalMatrix::Solve(const S21Matrix &b) const {
+  checkRows(GetSize(), b);
+  return InverseMatrix() * b;
+}
+
+S21Matrix operator*(const S21DiagonalMatrix &d, const S21Matrix &m) {
+  checkRows(d.GetSize(), m);
+  S21Matrix result(m);
+  for (int i = 0; i < m.GetRows(); i++) {
+    for (double &x : result.Row(i)) x *= d.diag_[i];
+  }
+  return result;
+}
+
+S21Matrix operator*(const S21Matrix &m, const S21DiagonalMatrix &d) {
+  checkCols(m, d.GetSize());
+  S21Matrix result(m);
+  for (int i = 0; i < m.GetRows(); i++) {
+    std::span<double> row = result.Row(i);
+    for (int j = 0; j < d.GetSize(); j++) row[j] *= d.diag_[j];
+  }
+  return result;
+}
+
+/* -------------- TRIANGULAR -------------- */
+
+S21TriangularMatrix::S21TriangularMatrix(int n, S21Triangle triangle)
+    : n_(n), triangle_(triangle) {
+  checkSize(n);
+  packed_.assign(static_cast<size_t>(n) * (n + 1) / 2, 0.0);
+}
+
+S21TriangularMatrix::S21TriangularMatrix(const S21Matrix &other,
+                                         S21Triangle triangle)
+    : n_(other.GetRows()), triangle_(triangle) {
+  checkSquare(other);
+  packed_.resize(static_cast<size_t>(n_) * (n_ + 1) / 2);
+  for (int i = 0; i < n_; i++) {
+    const int lo = triangle_ == S21Triangle::kUpper ? i : 0;
+    const int hi = triangle_ == S21Triangle::kUpper ? n_ : i + 1;
+    std::copy(other.Row(i).begin() + lo, other.Row(i).begin() + hi,
+              packed_.begin() + offset(i, lo));
+  }
+}
+
+size_t S21TriangularMatrix::offset(int i, int j) const noexcept {
+  const size_t row = i;
+  if (triangle_ == S21Triangle::kUpper) {
+    return row * (2 * n_ - row + 1) / 2 + (j - i);
+  }
+  return row * (row + 1) / 2 + j;
+}
+
+double S21TriangularMatrix::operator()(int i, int j) const {
+  checkIndex(n_, i, j);
+  return stored(i, j) ? packed_[offset(i, j)] : 0.0;
+}
+
+double &S21TriangularMatrix::operator()(int i, int j) {
+  checkIndex(n_, i, j);
+  if (!stored(i, j)) throwStructuralZero();
+  return packed_[offset(i, j)];
+}
+
+S21Matrix S21TriangularMatrix::ToMatrix() const {
+  S21Matrix result(n_, n_);
+  for (int i = 0; i < n_; i++) {
+    for (int j = 0; j < n_; j++) {
+      if (stored(i, j)) result.At(i, j) = packed_[offset(i, j)];
+    }
+  }
+  return result;
+}
+
+double S21TriangularMatrix::Determinant() const {
+  double det = 1.0;
+  for (int i = 0; i < n_; i++) det *= packed_[offset(i, i)];
+  return det;
+}
+
+S21Matrix S21TriangularMatrix::Solve(const S21Matrix &b) const {
+  checkRows(n_, b);
+  S21Matrix x(b);
+  const int nrhs = b.GetCols();
+  // Row-oriented substitution: each solved row of x is subtracted from the
+  // rows that still depend on it, keeping the inner loop contiguous.
+  auto eliminate = [&](int i) {
+    const double diag = packed_[offset(i, i)];
+    if (diag == 0.0) {
+      throw std::invalid_argument("ERROR: the matrix is singular");
+    }
+    double *xi = x.Row(i).data();
+    for (int c = 0; c < nrhs; c++) xi[c] /= diag;
+    const int lo = triangle_ == S21Triangle::kUpper ? 0 : i + 1;
+    const int hi = triangle_ == S21Triangle::kUpper ? i : n_;
+    for (int r = lo; r < hi; r++) {
+      const double coef = packed_[offset(r, i)];
+      if (coef == 0.0) continue;
+      double *xr = x.Row(r).data();
+      for (int c = 0; c < nrhs; c++) xr[c] -= coef * xi[c];
+    }
+  };
+  if (triangle_ == S21Triangle::kUpper) {
+    for (int i = n_ - 1; i >= 0; i--) eliminate(i);
+  } else {
+    for (int i = 0; i < n_; i++) eliminate(i);
+  }
+  return x;
+}
+
+S21Matrix operator*(const S21TriangularMatrix &t, const S21Matrix &m) {
+  checkRows(t.n_, m);
+  const int cols = m.GetCols();
+  S21Matrix result(t.n_, cols);
+  for (int i = 0; i < t.n_; i++) {
+    double *out = result.Row(i).data();
+    const int lo = t.triangle_ == S21Triangle::kUpper ? i : 0;
+    const int hi = t.triangle_ == S21Triangle::kUpper ? t.n_ : i + 1;
+    const double *packed_row = t.packed_.data() + t.offset(i, lo);
+    for (int p = lo; p < hi; p++) {
+      const double coef = packed_row[p - lo];
+      const double *src = m.Row(p).data();
+      for (int c = 0; c < cols; c++) out[c] += coef * src[c];
+    }
+  }
+  return result;
+}
+
+S21Matrix operator*(const S21Matrix &m, const S21TriangularMatrix &t) {
+  checkCols(m, t.n_);
+  S21Matrix result(m.GetRows(), t.n_);
+  for (int r = 0; r < m.GetRows(); r++) {
+    const double *src = m.Row(r).data();
+    double *out = result.Row(r).data();
+    for (int p = 0; p < t.n_; p++) {
+      const double coef = src[p];
+      if (coef == 0.0) continue;
+      const int lo = t.triangle_ == S21Triangle::kUpper ? p : 0;
+      const int hi = t.triangle_ == S21Triangle::kUpper ? t.n_ : p + 1;
+      const double *packed_row = t.packed_.data() + t.offset(p, lo);
+      for (int j = lo; j < hi; j++) out[j] += coef * packed_row[j - lo];
+    }
+  }
+  return result;
+}
+
+/* -------------- SYMMETRIC -------------- */
+
+S21SymmetricMatrix::S21SymmetricMatrix(int n) : n_(n) {
+  checkSize(n);
+  packed_.assign(static_cast<size_t>(n) * (n + 1) / 2, 0.0);
+}
+
+S21SymmetricMatrix::S21SymmetricMatrix(const S21Matrix &other)
+    : n_(other.GetRows()) {
+  checkSquare(other);
+  packed_.resize(static_cast<size_t>(n_) * (n_ + 1) / 2);
+  for (int i = 0; i < n_; i++) {
+    std::copy(other.Row(i).begin(), other.Row(i).begin() + i + 1,
+              packed_.begin() + offset(i, 0));
+  }
+}
+
+double S21SymmetricMatrix::operator()(int i, int j) const {
+  checkIndex(n_, i, j);
+  return packed_[offset(i, j)];
+}
+
+double &S21SymmetricMatrix::operator()(int i, int j) {
+  checkIndex(n_, i, j);
+  return packed_[offset(i, j)];
+}
+
+S21Matrix S21SymmetricMatrix::ToMatrix() const {
+  S21Matrix result(n_, n_);
+  for (int i = 0; i < n_; i++) {
+    for (int j = 0; j <= i; j++) {
+      result.At(i, j) = result.At(j, i) = packed_[offset(i, j)];
+    }
+  }
+  return result;
+}
+
+S21TriangularMatrix S21SymmetricMatrix::Cholesky() const {
+  S21TriangularMatrix l(n_, S21Triangle::kLower);
+  // Both pack the lower triangle row by row, so row i starts at offset(i, 0)
+  // in either, and the inner product runs over two contiguous rows of L.
+  double *factor = l.packed_.data();
+  for (int i = 0; i < n_; i++) {
+    const double *a_i = packed_.data() + offset(i, 0);
+    double *l_i = factor + offset(i, 0);
+    for (int j = 0; j <= i; j++) {
+      const double *l_j = factor + offset(j, 0);
+      double sum = a_i[j];
+      for (int k = 0; k < j; k++) sum -= l_i[k] * l_j[k];
+      if (i == j) {
+        if (sum <= 0.0) {
+          throw std::domain_error("ERROR: matrix is not positive definite");
+        }
+        l_i[i] = std::sqrt(sum);
+      } else {
+        l_i[j] = sum / l_j[j];
+      }
+    }
+  }
+  return l;
+}
+
+double S21SymmetricMatrix::Determinant() const {
+  try {
+    const double root = Cholesky().Determinant();
+    return root * root;
+  } catch (const std::domain_error &) {
+    return ToMatrix().Determinant();
+  }
+}
+
+S21Matrix S21SymmetricMatrix::Solve(const S21Matrix &b) const {
+  checkRows(n_, b);
+  // Only Cholesky throws std::domain_error here: L has a positive diagonal,
+  // so both substitutions succeed.
+  try {
+    const S21TriangularMatrix l = Cholesky();
+    // L * L^T * x = b: forward with L, then backward with L^T.
+    const S21Matrix y = l.Solve(b);
+    S21TriangularMatrix lt(n_, S21Triangle::kUpper);
+    for (int i = 0; i < n_; i++) {
+      for (int j = 0; j <= i; j++) {
+        lt.packed_[lt.offset(j, i)] = l.packed_[l.offset(i, j)];
+      }
+    }
+    return lt.Solve(y);
+  } catch (const std::domain_error &) {
+    return ToMatrix().Solve(b);
+  }
+}
+
+S21Matrix operator*(const S21SymmetricMatrix &s, const S21Matrix &m) {
+  checkRows(s.n_, m);
+  const int cols = m.GetCols();
+  S21Matrix result(s.n_, cols);
+  // Each stored entry (i, j), j < i, feeds both row i and row j.
+  for (int i = 0; i < s.n_; i++) {
+    const double *packed_row = s.packed_.data() + s.offset(i, 0);
+    double *out_i = result.Row(i).data();
+    const double *m_i = m.Row(i).data();
+    for (int j = 0; j < i; j++) {
+      const double a = packed_row[j];
+      const double *m_j = m.Row(j).data();
+      double *out_j = result.Row(j).data();
+      for (int c = 0; c < cols; c++) {
+        out_i[c] += a * m_j[c];
+        out_j[c] += a * m_i[c];
+      }
+    }
+    const double diag = packed_row[i];
+    for (int c = 0; c < cols; c++) out_i[c] += diag * m_i[c];
+  }
+  return result;
+}
+
+S21Matrix operator*(const S21Matrix &m, const S21SymmetricMatrix &s) {
+  checkCols(m, s.n_);
+  S21Matrix result(m.GetRows(), s.n_);
+  for (int r = 0; r < m.GetRows(); r++) {
+    const double *src = m.Row(r).data();
+    double *out = result.Row(r).data();
+    for (int i = 0; i < s.n_; i++) {
+      const double *packed_row = s.packed_.data() + s.offset(i, 0);
+      double sum = 0.0;
+      for (int j = 0; j < i; j++) {
+        sum += src[j] * packed_row[j];
+        out[j] += src[i] * packed_row[j];
+      }
+      out[i] += sum + src[i] * packed_row[i];
+    }
+  }
+  return result;
+}
+
+/* -------------- BANDED -------------- */
+
+S21BandedMatrix::S21BandedMatrix(int n, int lower, int upper)
+    : n_(n), lower_(lower), upper_(upper) {
+  checkSize(n);
+  if (lower < 0 || upper < 0 || lower >= n || upper >= n) {
+    throw std::invalid_argument("ERROR: bandwidth out of range");
+  }
+  band_.assign(static_cast<size_t>(n) * (lower + upper + 1), 0.0);
+}
+
+S21BandedMatrix::S21BandedMatrix(const S21Matrix &other, int lower, int upper)
+    : S21BandedMatrix(other.GetRows(), lower, upper) {
+  checkSquare(other);
+  for (int i = 0; i < n_; i++) {
+    for (int j = std::max(0, i - lower_); j <= std::min(n_ - 1, i + upper_);
+         j++) {
+      band_[offset(i, j)] = other.At(i, j);
+    }
+  }
+}
+
+double S21BandedMatrix::operator()(int i, int j) const {
+  checkIndex(n_, i, j);
+  return stored(i, j) ? band_[offset(i, j)] : 0.0;
+}
+
+double &S21BandedMatrix::operator()(int i, int j) {
+  checkIndex(n_, i, j);
+  if (!stored(i, j)) throwStructuralZero();
+  return band_[offset(i, j)];
+}
+
+S21Matrix S21BandedMatrix::ToMatrix() const {
+  S21Matrix result(n_, n_);
+  for (int i = 0; i < n_; i++) {
+    for (int j = std::max(0, i - lower_); j <= std::min(n_ - 1, i + upper_);
+         j++) {
+      result.At(i, j) = band_[offset(i, j)];
+    }
+  }
+  return result;
+}
+
+double S21BandedMatrix::factor(std::vector<double> &lu,
+                               std::vector<int> &pivots) const {
+  // Row i of `lu` covers columns i - lower .. i + lower + upper: pivoting can
+  // push fill-in up to `lower` extra diagonals above the original band.
+  const int width = 2 * lower_ + upper_ + 1;
+  auto at = [&](int i, int j) -> double & {
+    return lu[static_cast<size_t>(i) * width + (j - i + lower_)];
+  };
+  lu.assign(static_cast<size_t>(n_) * width, 0.0);
+  pivots.resize(n_);
+  for (int i = 0; i < n_; i++) {
+    for (int j = std::max(0, i - lower_); j <= std::min(n_ - 1, i + upper_);
+         j++) {
+      at(i, j) = band_[offset(i, j)];
+    }
+  }
+
+  double det = 1.0;
+  for (int k = 0; k < n_; k++) {
+    const int last_row = std::min(n_ - 1, k + lower_);
+    const int last_col = std::min(n_ - 1, k + lower_ + upper_);
+    int pivot = k;
+    for (int i = k + 1; i <= last_row; i++) {
+      if (std::fabs(at(i, k)) > std::fabs(at(pivot, k))) pivot = i;
+    }
+    pivots[k] = pivot;
+    if (pivot != k) {
+      for (int j = k; j <= last_col; j++) std::swap(at(k, j), at(pivot, j));
+      det = -det;
+    }
+    const double diag = at(k, k);
+    det *= diag;
+    if (diag == 0.0) return 0.0;
+    for (int i = k + 1; i <= last_row; i++) {
+      const double ratio = at(i, k) / diag;
+      at(i, k) = ratio;
+      for (int j = k + 1; j <= last_col; j++) at(i, j) -= ratio * at(k, j);
+    }
+  }
+  return det;
+}
+
+double S21BandedMatrix::Determinant() const {
+  std::vector<double> lu;
+  std::vector<int> pivots;
+  return factor(lu, pivots);
+}
+
+S21Matrix S21BandedMatrix::Solve(const S21Matrix &b) const {
+  checkRows(n_, b);
+  std::vector<double> lu;
+  std::vector<int> pivots;
+  if (factor(lu, pivots) == 0.0) {
+    throw std::invalid_argument("ERROR: the matrix is singular");
+  }
+  const int width = 2 * lower_ + upper_ + 1;
+  auto at = [&](int i, int j) {
+    return lu[static_cast<size_t>(i) * width + (j - i + lower_)];
+  };
+  S21Matrix x(b);
+  const int nrhs = b.GetCols();
+  for (int k = 0; k < n_; k++) {
+    if (pivots[k] != k) {
+      std::swap_ranges(x.Row(k).begin(), x.Row(k).end(),
+                       x.Row(pivots[k]).begin());
+    }
+    const double *xk = x.Row(k).data();
+    for (int i = k + 1; i <= std::min(n_ - 1, k + lower_); i++) {
+      const double l = at(i, k);
+      double *xi = x.Row(i).data();
+      for (int c = 0; c < nrhs; c++) xi[c] -= l * xk[c];
+    }
+  }
+  for (int i = n_ - 1; i >= 0; i--) {
+    double *xi = x.Row(i).data();
+    for (int j = i + 1; j <= std::min(n_ - 1, i + lower_ + upper_); j++) {
+      const double u = at(i, j);
+      const double *xj = x.Row(j).data();
+      for (int c = 0; c < nrhs; c++) xi[c] -= u * xj[c];
+    }
+    const double diag = at(i, i);
+    for (int c = 0; c < nrhs; c++) xi[c] /= diag;
+  }
+  return x;
+}
+
+S21Matrix operator*(const S21BandedMatrix &a, const S21Matrix &m) {
+  checkRows(a.n_, m);
+  const int cols = m.GetCols();
+  S21Matrix result(a.n_, cols);
+  for (int i = 0; i < a.n_; i++) {
+    double *out = result.Row(i).data();
+    for (int p = std::max(0, i - a.lower_);
+         p <= std::min(a.n_ - 1, i + a.upper_); p++) {
+      const double coef = a.band_[a.offset(i, p)];
+      const double *src = m.Row(p).data();
+      for (int c = 0; c < cols; c++) out[c] += coef * src[c];
+    }
+  }
+  return result;
+}
+
+S21Matrix operator*(const S21Matrix &m, const S21BandedMatrix &a) {
+  checkCols(m, a.n_);
+  S21Matrix result(m.GetRows(), a.n_);
+  for (int r = 0; r < m.GetRows(); r++) {
+    const double *src = m.Row(r).data();
+    double *out = result.Row(r).data();
+    for (int p = 0; p < a.n_; p++) {
+      const double coef = src[p];
+      for (int j = std::max(0, p - a.lower_);
+           j <= std::min(a.n_ - 1, p + a.upper_); j++) {
+        out[j] += coef * a.band_[a.offset(p, j)];
+      }
+    }
+  }
+  return result;
+}
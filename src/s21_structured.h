@@ -0,0 +1,151 @@
+#ifndef S21_STRUCTURED_H
+#define S21_STRUCTURED_H
+
+#include <utility>
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Square matrices with known structure. Each type stores only the entries
+// its structure allows and has kernels that exploit it. Products with a
+// dense S21Matrix are provided as overloaded operators, so mixed
+// expressions pick the structured kernel through overload resolution.
+//
+// Element access: the const operator() returns any (i, j), structural
+// zeros included; the non-const one only reaches stored entries and throws
+// std::domain_error for positions fixed at zero.
+
+enum class S21Triangle { kUpper, kLower };
+
+class S21DiagonalMatrix {
+ public:
+  explicit S21DiagonalMatrix(int n);
+  explicit S21DiagonalMatrix(const S21Matrix& other);  // keeps the diagonal
+
+  int GetSize() const noexcept { return static_cast<int>(diag_.size()); }
+  double operator()(int i, int j) const;
+  double& operator()(int i, int j);
+
+  S21Matrix ToMatrix() const;
+  double Determinant() const;  // O(n)
+  S21DiagonalMatrix InverseMatrix() const;
+  S21Matrix Solve(const S21Matrix& b) const;
+
+ private:
+  std::vector<double> diag_;
+
+  friend S21Matrix operator*(const S21DiagonalMatrix& d, const S21Matrix& m);
+  friend S21Matrix operator*(const S21Matrix& m, const S21DiagonalMatrix& d);
+};
+
+// Triangle packed row by row: n * (n + 1) / 2 doubles.
+class S21TriangularMatrix {
+ public:
+  S21TriangularMatrix(int n, S21Triangle triangle);
+  S21TriangularMatrix(const S21Matrix& other, S21Triangle triangle);
+
+  int GetSize() const noexcept { return n_; }
+  S21Triangle GetTriangle() const noexcept { return triangle_; }
+  double operator()(int i, int j) const;
+  double& operator()(int i, int j);
+
+  S21Matrix ToMatrix() const;
+  double Determinant() const;  // O(n)
+  // Forward or back substitution for every column of b, O(n^2) per column.
+  S21Matrix Solve(const S21Matrix& b) const;
+
+ private:
+  int n_;
+  S21Triangle triangle_;
+  std::vector<double> packed_;
+
+  bool stored(int i, int j) const noexcept {
+    return triangle_ == S21Triangle::kUpper ? j >= i : j <= i;
+  }
+  size_t offset(int i, int j) const noexcept;
+
+  friend S21Matrix operator*(const S21TriangularMatrix& t, const S21Matrix& m);
+  friend S21Matrix operator*(const S21Matrix& m, const S21TriangularMatrix& t);
+  // Cholesky writes its factor straight into packed_.
+  friend class S21SymmetricMatrix;
+};
+
+// Lower triangle packed row by row; (i, j) and (j, i) are the same entry.
+class S21SymmetricMatrix {
+ public:
+  explicit S21SymmetricMatrix(int n);
+  // Takes the lower triangle of `other`; the upper one is ignored.
+  explicit S21SymmetricMatrix(const S21Matrix& other);
+
+  int GetSize() const noexcept { return n_; }
+  double operator()(int i, int j) const;
+  double& operator()(int i, int j);
+
+  S21Matrix ToMatrix() const;
+  // Lower factor L with L * L^T = this; throws std::domain_error when the
+  // matrix is not positive definite.
+  S21TriangularMatrix Cholesky() const;
+  // Cholesky when positive definite, dense LU otherwise.
+  double Determinant() const;
+  S21Matrix Solve(const S21Matrix& b) const;
+
+ private:
+  int n_;
+  std::vector<double> packed_;
+
+  size_t offset(int i, int j) const noexcept {
+    if (j > i) std::swap(i, j);
+    return static_cast<size_t>(i) * (i + 1) / 2 + j;
+  }
+
+  friend S21Matrix operator*(const S21SymmetricMatrix& s, const S21Matrix& m);
+  friend S21Matrix operator*(const S21Matrix& m, const S21SymmetricMatrix& s);
+};
+
+// Band of `lower` sub- and `upper` super-diagonals, n * (lower + upper + 1)
+// doubles. Determinant and Solve use an LU with partial pivoting that stays
+// inside a band of width 2 * lower + upper + 1, O(n * lower * (lower +
+// upper)) instead of O(n^3).
+class S21BandedMatrix {
+ public:
+  S21BandedMatrix(int n, int lower, int upper);
+  S21BandedMatrix(const S21Matrix& other, int lower, int upper);
+
+  int GetSize() const noexcept { return n_; }
+  int GetLower() const noexcept { return lower_; }
+  int GetUpper() const noexcept { return upper_; }
+  double operator()(int i, int j) const;
+  double& operator()(int i, int j);
+
+  S21Matrix ToMatrix() const;
+  double Determinant() const;
+  S21Matrix Solve(const S21Matrix& b) const;
+
+ private:
+  int n_, lower_, upper_;
+  std::vector<double> band_;
+
+  bool stored(int i, int j) const noexcept {
+    return j - i <= upper_ && i - j <= lower_;
+  }
+  size_t offset(int i, int j) const noexcept {
+    return static_cast<size_t>(i) * (lower_ + upper_ + 1) + (j - i + lower_);
+  }
+  // Pivoted band LU: fills `lu` (row width 2 * lower + upper + 1) and
+  // `pivots`, returns the determinant.
+  double factor(std::vector<double>& lu, std::vector<int>& pivots) const;
+
+  friend S21Matrix operator*(const S21BandedMatrix& a, const S21Matrix& m);
+  friend S21Matrix operator*(const S21Matrix& m, const S21BandedMatrix& a);
+};
+
+S21Matrix operator*(const S21DiagonalMatrix& d, const S21Matrix& m);
+S21Matrix operator*(const S21Matrix& m, const S21DiagonalMatrix& d);
+S21Matrix operator*(const S21TriangularMatrix& t, const S21Matrix& m);
+S21Matrix operator*(const S21Matrix& m, const S21TriangularMatrix& t);
+S21Matrix operator*(const S21SymmetricMatrix& s, const S21Matrix& m);
+S21Matrix operator*(const S21Matrix& m, const S21SymmetricMatrix& s);
+S21Matrix operator*(const S21BandedMatrix& a, const S21Matrix& m);
+S21Matrix operator*(const S21Matrix& m, const S21BandedMatrix& a);
+
+#endif
@@ -0,0 +1,252 @@
+#include "s21_tiled.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "s21_parallel.h"
+#include "s21_tuning.h"
+
+namespace {
+
+int tilesFor(int extent, int tile) { return (extent + tile - 1) / tile; }
+
+template <typename Body>
+void forEachTile(size_t tiles, size_t tile_size, const Body &body) {
+  if (tiles * tile_size < s21::Tuning().tiled_parallel_threshold) {
+    body(size_t{0}, tiles);
+  } else {
+    s21::ParallelFor(0, tiles, 1, body);
+  }
+}
+
+}  // namespace
+
+S21TiledMatrix::S21TiledMatrix() noexcept
+    : rows_(0), cols_(0), tile_(DefaultTile()), tile_rows_(0), tile_cols_(0) {}
+
+int S21TiledMatrix::DefaultTile() noexcept {
+  // Far beyond any cache, and tile * tile stays well inside an int.
+  return static_cast<int>(std::min<size_t>(s21::Tuning().tiled_tile, 1024));
+}
+
+S21TiledMatrix::S21TiledMatrix(int rows, int cols, int tile)
+    : rows_(rows), cols_(cols), tile_(tile) {
+  if (rows_ <= 0 || cols_ <= 0) {
+    throw std::domain_error(
+        "ERROR: Rows and columns must be greater than zero");
+  }
+  if (tile_ <= 0) {
+    throw std::invalid_argument("ERROR: Tile size must be greater than zero");
+  }
+  tile_rows_ = tilesFor(rows_, tile_);
+  tile_cols_ = tilesFor(cols_, tile_);
+  data_.assign(static_cast<size_t>(tile_rows_) * tile_cols_ * tile_ * tile_,
+               0.0);
+}
+
+S21TiledMatrix::S21TiledMatrix(const S21Matrix &other, int tile)
+    : S21TiledMatrix(other.GetRows(), other.GetCols(), tile) {
+  const double *src = other.data();
+  const size_t ld = cols_;
+  forEachTile(tile_rows_, static_cast<size_t>(tile_) * cols_,
+              [&](size_t first, size_t last) {
+                for (size_t ti = first; ti < last; ti++) {
+                  for (int tj = 0; tj < tile_cols_; tj++) {
+                    double *dst = tileAt(ti, tj);
+                    const int i0 = ti * tile_, j0 = tj * tile_;
+                    const int h = std::min(tile_, rows_ - i0);
+                    const int w = std::min(tile_, cols_ - j0);
+                    for (int r = 0; r < h; r++) {
+                      std::memcpy(dst + r * tile_, src + (i0 + r) * ld + j0,
+                                  sizeof(double) * w);
+                    }
+                  }
+                }
+              });
+}
+
+S21Matrix S21TiledMatrix::ToMatrix() const {
+  S21Matrix result(rows_, cols_, S21Matrix::uninitialized);
+  double *dst = result.data();
+  const size_t ld = cols_;
+  forEachTile(tile_rows_, static_cast<size_t>(tile_) * cols_,
+              [&](size_t first, size_t last) {
+                for (size_t ti = first; ti < last; ti++) {
+                  for (int tj = 0; tj < tile_cols_; tj++) {
+                    const double *src = tileAt(ti, tj);
+                    const int i0 = ti * tile_, j0 = tj * tile_;
+                    const int h = std::min(tile_, rows_ - i0);
+                    const int w = std::min(tile_, cols_ - j0);
+                    for (int r = 0; r < h; r++) {
+                      std::memcpy(dst + (i0 + r) * ld + j0, src + r * tile_,
+                                  sizeof(double) * w);
+                    }
+                  }
+                }
+              });
+  return result;
+}
+
+size_t S21TiledMatrix::offset(int i, int j) const noexcept {
+  const int ti = i / tile_, tj = j / tile_;
+  return (static_cast<size_t>(ti) * tile_cols_ + tj) * tile_ * tile_ +
+         static_cast<size_t>(i % tile_) * tile_ + j % tile_;
+}
+
+double &S21TiledMatrix::operator()(int i, int j) {
+  if (i >= rows_ || j >= cols_ || i < 0 || j < 0) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return data_[offset(i, j)];
+}
+
+const double &S21TiledMatrix::operator()(int i, int j) const {
+  if (i >= rows_ || j >= cols_ || i < 0 || j < 0) {
+    throw std::domain_error("ERROR: segmentation fault");
+  }
+  return data_[offset(i, j)];
+}
+
+void S21TiledMatrix::checkSameShape(const S21TiledMatrix &other) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_ || tile_ != other.tile_) {
+    throw std::invalid_argument("ERROR: invalid");
+  }
+}
+
+// Element-wise kernels run over the padded buffer as a whole: both operands
+// share the layout and the padding stays zero under +, - and scaling.
+void S21TiledMatrix::SumMatrix(const S21TiledMatrix &other) {
+  checkSameShape(other);
+  double *dst = data_.data();
+  const double *src = other.data_.data();
+  const size_t tile_size = static_cast<size_t>(tile_) * tile_;
+  forEachTile(data_.size() / tile_size, tile_size,
+              [=](size_t first, size_t last) {
+                for (size_t i = first * tile_size; i < last * tile_size; i++) {
+                  dst[i] += src[i];
+                }
+              });
+}
+
+void S21TiledMatrix::SubMatrix(const S21TiledMatrix &other) {
+  checkSameShape(other);
+  double *dst = data_.data();
+  const double *src = other.data_.data();
+  const size_t tile_size = static_cast<size_t>(tile_) * tile_;
+  forEachTile(data_.size() / tile_size, tile_size,
+              [=](size_t first, size_t last) {
+                for (size_t i = first * tile_size; i < last * tile_size; i++) {
+                  dst[i] -= src[i];
+                }
+              });
+}
+
+void S21TiledMatrix::MulNumber(const double num) {
+  double *dst = data_.data();
+  const size_t tile_size = static_cast<size_t>(tile_) * tile_;
+  forEachTile(data_.size() / tile_size, tile_size,
+              [=](size_t first, size_t last) {
+                for (size_t i = first * tile_size; i < last * tile_size; i++) {
+                  dst[i] *= num;
+                }
+              });
+}
+
+bool S21TiledMatrix::EqMatrix(const S21TiledMatrix &other) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+  if (tile_ != other.tile_) {
+    return ToMatrix().EqMatrix(other.ToMatrix());
+  }
+  const double *lhs = data_.data();
+  const double *rhs = other.data_.data();
+  const size_t tile_size = static_cast<size_t>(tile_) * tile_;
+  std::atomic<bool> equal(true);
+  forEachTile(data_.size() / tile_size, tile_size,
+              [&](size_t first, size_t last) {
+                for (size_t i = first * tile_size;
+                     i < last * tile_size &&
+                     equal.load(std::memory_order_relaxed);
+                     i++) {
+                  if (std::fabs(lhs[i] - rhs[i]) >= 1e-7) equal = false;
+                }
+              });
+  return equal;
+}
+
+void S21TiledMatrix::MulMatrix(const S21TiledMatrix &other) {
+  S21TiledMatrix result;
+  Mul(*this, other, result);
+  *this = std::move(result);
+}
+
+void S21TiledMatrix::Mul(const S21TiledMatrix &a, const S21TiledMatrix &b,
+                         S21TiledMatrix &c) {
+  if (a.cols_ != b.rows_ || a.tile_ != b.tile_) {
+    throw std::invalid_argument("ERROR");
+  }
+  if (&c == &a || &c == &b) {
+    S21TiledMatrix result;
+    Mul(a, b, result);
+    c = std::move(result);
+    return;
+  }
+  if (c.rows_ != a.rows_ || c.cols_ != b.cols_ || c.tile_ != a.tile_) {
+    c = S21TiledMatrix(a.rows_, b.cols_, a.tile_);
+  } else {
+    std::fill(c.data_.begin(), c.data_.end(), 0.0);
+  }
+  const int t = a.tile_;
+  const int inner_tiles = a.tile_cols_;
+  const int out_cols = c.tile_cols_;
+  // One task per output tile row; every tile product reads two contiguous
+  // t x t blocks and accumulates into a third.
+  auto body = [&](size_t first, size_t last) {
+    for (size_t ti = first; ti < last; ti++) {
+      s21::ThrowIfCancelled();
+      for (int tj = 0; tj < out_cols; tj++) {
+        double *tc = c.tileAt(ti, tj);
+        for (int tp = 0; tp < inner_tiles; tp++) {
+          const double *ta = a.tileAt(ti, tp);
+          const double *tb = b.tileAt(tp, tj);
+          for (int i = 0; i < t; i++) {
+            double *c_row = tc + i * t;
+            for (int p = 0; p < t; p++) {
+              const double a_ip = ta[i * t + p];
+              const double *b_row = tb + p * t;
+              for (int j = 0; j < t; j++) c_row[j] += a_ip * b_row[j];
+            }
+          }
+        }
+      }
+    }
+  };
+  const size_t flops = static_cast<size_t>(a.rows_) * a.cols_ * b.cols_;
+  if (flops < s21::Tuning().tiled_mul_parallel_flops) {
+    body(0, a.tile_rows_);
+  } else {
+    s21::ParallelFor(0, a.tile_rows_, 1, body);
+  }
+}
+
+S21TiledMatrix S21TiledMatrix::Transpose() const {
+  S21TiledMatrix result(cols_, rows_, tile_);
+  const int t = tile_;
+  forEachTile(tile_rows_, static_cast<size_t>(t) * cols_,
+              [&](size_t first, size_t last) {
+                for (size_t ti = first; ti < last; ti++) {
+                  for (int tj = 0; tj < tile_cols_; tj++) {
+                    const double *src = tileAt(ti, tj);
+                    double *dst = result.tileAt(tj, ti);
+                    for (int i = 0; i < t; i++) {
+                      for (int j = 0; j < t; j++) dst[j * t + i] = src[i * t + j];
+                    }
+                  }
+                }
+              });
+  return result;
+}
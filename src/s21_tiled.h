@@ -0,0 +1,59 @@
+#ifndef S21_TILED_H
+#define S21_TILED_H
+
+#include <vector>
+
+#include "s21_matrix.h"
+
+// Dense matrix stored as square tiles: tiles are laid out row by row and
+// each tile is a contiguous row-major block of tile * tile doubles. Column
+// walks (transpose, the B operand of a product) then stay inside a few
+// pages instead of striding across the whole matrix. Edge tiles are padded
+// with zeros, which every kernel keeps at zero.
+class S21TiledMatrix {
+ public:
+  // The tuned tile edge, s21::Tuning().tiled_tile.
+  static int DefaultTile() noexcept;
+
+  S21TiledMatrix() noexcept;
+  S21TiledMatrix(int rows, int cols, int tile = DefaultTile());
+  explicit S21TiledMatrix(const S21Matrix& other, int tile = DefaultTile());
+
+  S21Matrix ToMatrix() const;
+
+  int GetRows() const noexcept { return rows_; }
+  int GetCols() const noexcept { return cols_; }
+  int GetTile() const noexcept { return tile_; }
+
+  double& operator()(int i, int j);
+  const double& operator()(int i, int j) const;
+
+  void SumMatrix(const S21TiledMatrix& other);
+  void SubMatrix(const S21TiledMatrix& other);
+  void MulNumber(const double num);
+  void MulMatrix(const S21TiledMatrix& other);
+  // c = a * b, reusing the storage of c when it already has the shape and
+  // tile size of the product.
+  static void Mul(const S21TiledMatrix& a, const S21TiledMatrix& b,
+                  S21TiledMatrix& c);
+  S21TiledMatrix Transpose() const;
+  bool EqMatrix(const S21TiledMatrix& other) const;
+
+ private:
+  int rows_, cols_, tile_;
+  int tile_rows_, tile_cols_;
+  std::vector<double> data_;
+
+  double* tileAt(int ti, int tj) noexcept {
+    return data_.data() + (static_cast<size_t>(ti) * tile_cols_ + tj) *
+                              tile_ * tile_;
+  }
+  const double* tileAt(int ti, int tj) const noexcept {
+    return data_.data() + (static_cast<size_t>(ti) * tile_cols_ + tj) *
+                              tile_ * tile_;
+  }
+  size_t offset(int i, int j) const noexcept;
+  void checkSameShape(const S21TiledMatrix& other) const;
+};
+
+#endif
@@ -0,0 +1,268 @@
+// Measures the s21::Tunables on this host and saves them as the tuning
+// profile that the library loads at startup. Run with `make tune`; an
+// argument overrides the profile path.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "s21_backend.h"
+#include "s21_decomp.h"
+#include "s21_matrix.h"
+#include "s21_quantized.h"
+#include "s21_tiled.h"
+#include "s21_tuning.h"
+
+namespace {
+
+using s21::Tunables;
+
+template <typename F>
+double bestOf(int repeats, const F &f) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (elapsed.count() < best) best = elapsed.count();
+  }
+  return best;
+}
+
+// Best of at least three runs, and of as many more as fit in 50 ms, so that
+// small problems are timed often enough to be stable.
+template <typename F>
+double bestWithin(const F &f) {
+  double best = 1e300, total = 0.0;
+  for (int r = 0; r < 200 && (r < 3 || total < 0.05); r++) {
+    const double time = bestOf(1, f);
+    total += time;
+    best = std::min(best, time);
+  }
+  return best;
+}
+
+S21Matrix filled(int rows, int cols) {
+  S21Matrix m(rows, cols, S21Matrix::uninitialized);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) m.At(i, j) = (i * 31 + j * 17) % 13 - 6.0;
+  }
+  return m;
+}
+
+// filled() with a dominant diagonal, so that LU runs every step.
+S21Matrix invertible(int n) {
+  S21Matrix m = filled(n, n);
+  for (int i = 0; i < n; i++) m.At(i, i) += 8.0 * n;
+  return m;
+}
+
+// The candidate for which run() is fastest, all other fields as in `base`.
+template <typename F>
+size_t fastest(const char *name, const std::vector<size_t> &candidates,
+               const Tunables &base, size_t Tunables::*member, const F &run) {
+  size_t best = base.*member;
+  double best_time = 1e300;
+  for (size_t candidate : candidates) {
+    Tunables trial = base;
+    trial.*member = candidate;
+    s21::SetTuning(trial);
+    run();  // warm-up
+    const double time = bestOf(5, run);
+    std::printf("%-28s %10zu %12.6f\n", name, candidate, time);
+    if (time < best_time) {
+      best_time = time;
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+// Smallest work size from which the parallel path beats the serial one at
+// that size and every larger one. setup(size) prepares the operands and
+// returns the operation; `threshold` is the cutoff being measured. The
+// parallel side only lowers the cutoff, so it splits the work with the
+// chunk sizes already in `base`, as the library will: below one chunk it
+// runs serially and cannot win.
+template <typename Setup>
+size_t crossover(const char *name, const std::vector<size_t> &sizes,
+                 const Tunables &base, size_t Tunables::*threshold,
+                 const Setup &setup) {
+  size_t result = sizes.back() * 2;  // parallel never paid off
+  bool winning = true;
+  std::vector<bool> parallel_wins;
+  for (size_t size : sizes) {
+    const auto run = setup(size);
+    Tunables serial = base, parallel = base;
+    serial.*threshold = std::numeric_limits<size_t>::max();
+    parallel.*threshold = 1;
+    s21::SetTuning(serial);
+    run();
+    const double serial_time = bestWithin(run);
+    s21::SetTuning(parallel);
+    run();
+    const double parallel_time = bestWithin(run);
+    std::printf("%-28s %10zu %12.6f %12.6f\n", name, size, serial_time,
+                parallel_time);
+    parallel_wins.push_back(parallel_time < serial_time);
+  }
+  for (size_t i = sizes.size(); i-- > 0;) {
+    winning = winning && parallel_wins[i];
+    if (winning) result = sizes[i];
+  }
+  return result;
+}
+
+// Smallest n with cost(n) >= work.
+template <typename Cost>
+int sizeFor(size_t work, const Cost &cost) {
+  int n = 2;
+  while (cost(static_cast<size_t>(n)) < work) n++;
+  return n;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const std::string path =
+      argc > 1 ? argv[1] : s21::DefaultTuningProfilePath();
+  s21::SetBackend(s21::BuiltinBackend());
+  Tunables tuned;
+  std::printf("%-28s %10s %12s %12s\n", "parameter", "value", "time",
+              "parallel");
+
+  // Block sizes first, with the default cutoffs.
+  {
+    const S21Matrix a = filled(2048, 2048);
+    tuned.transpose_tile =
+        fastest("transpose_tile", {8, 16, 32, 64, 128}, tuned,
+                &Tunables::transpose_tile, [&a] { a.Transpose(); });
+  }
+  {
+    const S21Matrix a = filled(512, 512);
+    S21Matrix c;
+    tuned.gemm_k_block = fastest(
+        "gemm_k_block", {32, 64, 128, 256, 512}, tuned,
+        &Tunables::gemm_k_block, [&] { S21Matrix::Gemm(1.0, a, a, 0.0, c); });
+  }
+  {
+    S21Matrix a = filled(2048, 2048);
+    const S21Matrix b = a;
+    tuned.parallel_grain =
+        fastest("parallel_grain",
+                {1 << 11, 1 << 12, 1 << 13, 1 << 14, 1 << 15, 1 << 16},
+                tuned, &Tunables::parallel_grain, [&] { a.SumMatrix(b); });
+  }
+  {
+    // The tile is fixed at construction, so each run converts the operands.
+    const S21Matrix a = filled(512, 512);
+    S21TiledMatrix c;
+    tuned.tiled_tile = fastest("tiled_tile", {16, 32, 64, 128}, tuned,
+                               &Tunables::tiled_tile, [&] {
+                                 const S21TiledMatrix t(a);
+                                 S21TiledMatrix::Mul(t, t, c);
+                               });
+  }
+
+  {
+    const S21Matrix a = filled(512, 512);
+    S21Matrix c;
+    tuned.gemm_grain_flops = fastest(
+        "gemm_grain_flops", {1 << 14, 1 << 16, 1 << 18, 1 << 20, 1 << 22},
+        tuned, &Tunables::gemm_grain_flops,
+        [&] { S21Matrix::Gemm(1.0, a, a, 0.0, c); });
+  }
+
+  // Then the single- vs multi-thread crossovers, with the tuned chunk sizes.
+  const std::vector<size_t> cubic = {size_t{1} << 12, size_t{1} << 15,
+                                     size_t{1} << 18, size_t{1} << 21,
+                                     size_t{1} << 24};
+  tuned.parallel_threshold = crossover(
+      "parallel_threshold",
+      {1 << 12, 1 << 13, 1 << 14, 1 << 15, 1 << 16, 1 << 17, 1 << 18},
+      tuned, &Tunables::parallel_threshold, [](size_t size) {
+        auto a =
+            std::make_shared<S21Matrix>(filled(1, static_cast<int>(size)));
+        auto b = std::make_shared<const S21Matrix>(*a);
+        return [a, b] { a->SumMatrix(*b); };
+      });
+  tuned.gemm_parallel_flops = crossover(
+      "gemm_parallel_flops", cubic, tuned, &Tunables::gemm_parallel_flops,
+      [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n * n; });
+        auto a = std::make_shared<const S21Matrix>(filled(n, n));
+        auto c = std::make_shared<S21Matrix>();
+        return [a, c] { S21Matrix::Gemm(1.0, *a, *a, 0.0, *c); };
+      });
+  tuned.syrk_parallel_flops = crossover(
+      "syrk_parallel_flops", cubic, tuned, &Tunables::syrk_parallel_flops,
+      [](size_t flops) {
+        const int n =
+            sizeFor(flops, [](size_t n) { return n * (n + 1) / 2 * n; });
+        auto a = std::make_shared<const S21Matrix>(filled(n, n));
+        return [a] { a->Gram(); };
+      });
+  // The cutoff applies to each elimination step, (n - k - 1)^2 multiply-adds;
+  // a factorization of size n is dominated by its first steps, about n^2.
+  tuned.lu_parallel_flops = crossover(
+      "lu_parallel_flops",
+      {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18}, tuned,
+      &Tunables::lu_parallel_flops, [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n; });
+        auto a = std::make_shared<const S21Matrix>(invertible(n));
+        return [a] { a->Determinant(); };
+      });
+  tuned.adjugate_parallel_flops = crossover(
+      "adjugate_parallel_flops", {cubic.begin(), cubic.end() - 1}, tuned,
+      &Tunables::adjugate_parallel_flops, [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n * n; });
+        auto a = std::make_shared<const S21Matrix>(invertible(n));
+        return [a] { a->Adjugate(); };
+      });
+  tuned.tiled_parallel_threshold = crossover(
+      "tiled_parallel_threshold",
+      {1 << 12, 1 << 13, 1 << 14, 1 << 15, 1 << 16, 1 << 17, 1 << 18},
+      tuned, &Tunables::tiled_parallel_threshold, [](size_t size) {
+        const int n = sizeFor(size, [](size_t n) { return n * n; });
+        auto a = std::make_shared<S21TiledMatrix>(filled(n, n));
+        auto b = std::make_shared<const S21TiledMatrix>(*a);
+        return [a, b] { a->SumMatrix(*b); };
+      });
+  tuned.tiled_mul_parallel_flops = crossover(
+      "tiled_mul_parallel_flops", cubic, tuned,
+      &Tunables::tiled_mul_parallel_flops, [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n * n; });
+        auto a = std::make_shared<const S21TiledMatrix>(filled(n, n));
+        auto c = std::make_shared<S21TiledMatrix>();
+        return [a, c] { S21TiledMatrix::Mul(*a, *a, *c); };
+      });
+  tuned.quantized_parallel_threshold = crossover(
+      "quantized_parallel_threshold", cubic, tuned,
+      &Tunables::quantized_parallel_threshold, [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n * n; });
+        const S21Matrix m = filled(n, n);
+        auto a = std::make_shared<const S21QuantizedMatrix8>(m);
+        auto b = std::make_shared<const S21QuantizedMatrix8>(
+            S21QuantizedMatrix8::FromColumns(m));
+        return [a, b] { a->MulMatrix(*b); };
+      });
+  // As for LU, the first updates of size about n^2 dominate.
+  tuned.reflector_parallel_flops = crossover(
+      "reflector_parallel_flops",
+      {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18}, tuned,
+      &Tunables::reflector_parallel_flops, [](size_t flops) {
+        const int n = sizeFor(flops, [](size_t n) { return n * n; });
+        auto a = std::make_shared<const S21Matrix>(invertible(n));
+        return [a] { s21::Qr(*a); };
+      });
+
+  s21::SetTuning(tuned);
+  s21::SaveTuningProfile(path, tuned);
+  std::printf("wrote %s\n", path.c_str());
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include "s21_tuning.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#ifndef S21_TUNING_PROFILE_PATH
+#define S21_TUNING_PROFILE_PATH "/usr/local/share/s21_matrix/tuning.profile"
+#endif
+
+namespace s21 {
+
+namespace {
+
+struct Field {
+  const char *name;
+  size_t Tunables::*member;
+};
+
+constexpr Field kFields[] = {
+    {"parallel_threshold", &Tunables::parallel_threshold},
+    {"parallel_grain", &Tunables::parallel_grain},
+    {"gemm_parallel_flops", &Tunables::gemm_parallel_flops},
+    {"gemm_grain_flops", &Tunables::gemm_grain_flops},
+    {"syrk_parallel_flops", &Tunables::syrk_parallel_flops},
+    {"lu_parallel_flops", &Tunables::lu_parallel_flops},
+    {"adjugate_parallel_flops", &Tunables::adjugate_parallel_flops},
+    {"gemm_k_block", &Tunables::gemm_k_block},
+    {"transpose_tile", &Tunables::transpose_tile},
+    {"tiled_parallel_threshold", &Tunables::tiled_parallel_threshold},
+    {"tiled_mul_parallel_flops", &Tunables::tiled_mul_parallel_flops},
+    {"tiled_tile", &Tunables::tiled_tile},
+    {"quantized_parallel_threshold", &Tunables::quantized_parallel_threshold},
+    {"reflector_parallel_flops", &Tunables::reflector_parallel_flops},
+};
+
+std::string_view trim(std::string_view text) {
+  const size_t first = text.find_first_not_of(" \t\r");
+  if (first == std::string_view::npos) return {};
+  const size_t last = text.find_last_not_of(" \t\r");
+  return text.substr(first, last - first + 1);
+}
+
+void validate(const Tunables &tunables) {
+  for (const Field &field : kFields) {
+    if (tunables.*field.member == 0) {
+      throw std::invalid_argument(std::string("ERROR: ") + field.name +
+                                  " must be positive");
+    }
+  }
+}
+
+// Every installed value set stays alive, so references returned by
+// Tuning() never dangle; SetTuning is rare, so they are few.
+const Tunables *keep(const Tunables &tunables) {
+  static std::mutex mutex;
+  static std::vector<std::unique_ptr<const Tunables>> kept;
+  std::lock_guard lock(mutex);
+  kept.push_back(std::make_unique<const Tunables>(tunables));
+  return kept.back().get();
+}
+
+Tunables initialTuning() {
+  try {
+    return LoadTuningProfile(DefaultTuningProfilePath());
+  } catch (const std::exception &) {
+    return Tunables{};
+  }
+}
+
+std::atomic<const Tunables *> &current() {
+  static std::atomic<const Tunables *> tunables{keep(initialTuning())};
+  return tunables;
+}
+
+}  // namespace
+
+const Tunables &Tuning() noexcept {
+  return *current().load(std::memory_order_acquire);
+}
+
+void SetTuning(const Tunables &tunables) {
+  validate(tunables);
+  current().store(keep(tunables), std::memory_order_release);
+}
+
+Tunables LoadTuningProfile(const std::string &path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("ERROR: cannot open " + path);
+  Tunables tunables;
+  std::string line;
+  while (std::getline(in, line)) {
+    const std::string_view text = trim(line);
+    if (text.empty() || text.front() == '#') continue;
+    const size_t equals = text.find('=');
+    if (equals == std::string_view::npos) {
+      throw std::invalid_argument("ERROR: malformed tuning line: " + line);
+    }
+    const std::string_view name = trim(text.substr(0, equals));
+    const std::string_view value = trim(text.substr(equals + 1));
+    for (const Field &field : kFields) {
+      if (name != field.name) continue;
+      size_t parsed = 0;
+      const auto [end, error] =
+          std::from_chars(value.data(), value.data() + value.size(), parsed);
+      if (error != std::errc() || end != value.data() + value.size()) {
+        throw std::invalid_argument("ERROR: malformed tuning line: " + line);
+      }
+      tunables.*field.member = parsed;
+    }
+  }
+  if (in.bad()) throw std::runtime_error("ERROR: read failed");
+  validate(tunables);
+  return tunables;
+}
+
+void SaveTuningProfile(const std::string &path, const Tunables &tunables) {
+  std::ofstream out(path);
+  if (!out) throw std::runtime_error("ERROR: cannot open " + path);
+  out << "# S21Matrix tuning profile, written by s21_tune\n";
+  for (const Field &field : kFields) {
+    out << field.name << " = " << tunables.*field.member << '\n';
+  }
+  out.flush();
+  if (!out) throw std::runtime_error("ERROR: write failed");
+}
+
+std::string DefaultTuningProfilePath() {
+  const char *env = std::getenv("S21_TUNING_PROFILE");
+  return env != nullptr && *env != '\0' ? env : S21_TUNING_PROFILE_PATH;
+}
+
+}  // namespace s21
@@ -0,0 +1,73 @@
+#ifndef S21_TUNING_H
+#define S21_TUNING_H
+
+#include <cstddef>
+#include <string>
+
+namespace s21 {
+
+// Block sizes and single- vs multi-thread crossovers of the dense kernels.
+// The defaults are safe on any host; `make tune` measures better ones and
+// writes them to a profile that the library reads on first use. Each
+// cutoff only decides whether a kernel goes parallel; the chunk sizes it
+// then uses are separate fields.
+struct Tunables {
+  // Element-wise work, in elements, from which a kernel goes parallel.
+  size_t parallel_threshold = 1 << 16;
+  // Smallest slice of elements handed to one thread, also by LU.
+  size_t parallel_grain = 1 << 14;
+  // Multiply-adds from which Gemm goes parallel.
+  size_t gemm_parallel_flops = 1 << 18;
+  // Multiply-adds per parallel chunk of Gemm and Syrk.
+  size_t gemm_grain_flops = 1 << 18;
+  // Multiply-adds of the triangle from which Syrk goes parallel.
+  size_t syrk_parallel_flops = 1 << 18;
+  // Multiply-adds of one elimination step, (n - k - 1)^2, from which LU
+  // updates the trailing rows in parallel.
+  size_t lu_parallel_flops = 1 << 18;
+  // n^3 from which the triangular passes of the adjugate go parallel.
+  size_t adjugate_parallel_flops = 1 << 18;
+  // Rows of B swept per pass of Gemm, so that the panel stays in cache.
+  size_t gemm_k_block = 256;
+  // Edge of the square tiles of Transpose.
+  size_t transpose_tile = 32;
+  // Elements of an S21TiledMatrix from which its element-wise loops,
+  // conversions and Transpose go parallel.
+  size_t tiled_parallel_threshold = 1 << 16;
+  // Multiply-adds from which S21TiledMatrix::Mul goes parallel.
+  size_t tiled_mul_parallel_flops = 1 << 18;
+  // Tile edge of an S21TiledMatrix constructed without one.
+  size_t tiled_tile = 64;
+  // Elements, or multiply-adds for MulMatrix, from which the row loops of
+  // S21QuantizedMatrix go parallel.
+  size_t quantized_parallel_threshold = 1 << 16;
+  // Multiply-adds of one Householder update, from which Qr, Svd and
+  // SymmetricEigen apply it in parallel.
+  size_t reflector_parallel_flops = 1 << 16;
+};
+
+// The values in effect. On first use they are read from the profile at
+// DefaultTuningProfilePath(), falling back to the defaults when it is
+// missing or invalid. A reference kept across SetTuning stays valid but
+// keeps showing the values it was taken with.
+const Tunables& Tuning() noexcept;
+// Installs new values; every field must be positive.
+void SetTuning(const Tunables& tunables);
+
+// The profile is text, one `name = value` line per field. Blank lines and
+// lines starting with '#' are skipped, unknown names are ignored and
+// missing fields keep their defaults. Loading throws std::runtime_error
+// when the file cannot be read and std::invalid_argument on a malformed
+// line or value.
+Tunables LoadTuningProfile(const std::string& path);
+void SaveTuningProfile(const std::string& path, const Tunables& tunables);
+// $S21_TUNING_PROFILE, or else the path the library was configured with,
+// S21_TUNING_PROFILE_PATH; the Makefile sets it to $(TUNING_PROFILE), which
+// is also where `make tune` writes. Under the default PREFIX=/usr/local
+// that needs root; pass a writable TUNING_PROFILE to both the build and
+// `make tune` otherwise.
+std::string DefaultTuningProfilePath();
+
+}  // namespace s21
+
+#endif